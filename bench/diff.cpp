@@ -0,0 +1,99 @@
+//!
+//! termcolor's diff benchmark
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Diffs generated texts of 100k lines (by default) against edited copies
+//! of themselves: a few scattered edits, an edit every tenth line, and a
+//! text with no line in common, in unified and side-by-side layouts, and
+//! reports the time of each.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "termcolor/termcolor.hpp"
+#include "termcolor/diff.hpp"
+
+using namespace termcolor;
+
+static std::string sample(size_t lines, char const* prefix)
+{
+    std::string text;
+    for (size_t i = 0; i < lines; ++i)
+    {
+        char line[128];
+        ::snprintf(line, sizeof(line), "%s %zu: value = compute(%zu, \"item-%zu\");\n",
+            prefix, i, i % 977, i * 7919 % 100003);
+        text += line;
+    }
+    return text;
+}
+
+//! A copy of \a text with every \a period-th line edited in turn: a word
+//! changed, the line dropped, or a line added after it.
+static std::string edit(std::string const& text, size_t period)
+{
+    std::string out;
+    size_t line = 0;
+    for (size_t p = 0; p < text.size(); ++line)
+    {
+        size_t eol = text.find('\n', p) + 1;
+        std::string current = text.substr(p, eol - p);
+        p = eol;
+        if (line % period != period / 2)
+        {
+            out += current;
+            continue;
+        }
+        switch (line / period % 3)
+        {
+            case 0:
+                current.replace(current.find("value"), 5, "result");
+                out += current;
+                break;
+            case 1:
+                break;
+            default:
+                out += current;
+                out += "    inserted line\n";
+                break;
+        }
+    }
+    return out;
+}
+
+static void run(char const* name, std::string const& from, std::string const& to, diff::layout layout)
+{
+    std::string out;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    diff().set_layout(layout).render(out, from, to);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "diff " << name << (layout == diff::unified ? " (unified): " : " (side by side): ")
+              << elapsed.count() << " s, " << (static_cast<double>(out.size()) / (1 << 20)) << " MiB out"
+              << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    size_t lines = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 100000;
+    std::string text = sample(lines, "line");
+    std::string scattered = edit(text, 1000);
+    std::string dense = edit(text, 10);
+    std::string other = sample(lines, "other");
+
+    std::cout << "diff: " << lines << " lines, " << (static_cast<double>(text.size()) / (1 << 20))
+              << " MiB per side" << std::endl;
+    for (int l = diff::unified; l <= diff::side_by_side; ++l)
+    {
+        diff::layout layout = static_cast<diff::layout>(l);
+        run("scattered edits", text, scattered, layout);
+        run("dense edits", text, dense, layout);
+        run("nothing in common", text, other, layout);
+    }
+    return 0;
+}
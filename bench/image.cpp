@@ -0,0 +1,104 @@
+//!
+//! termcolor's image benchmark
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Renders a generated 4K (3840x2160) image with half blocks and reports
+//! the output size and time: the naive way (a `color()` and an
+//! `on_color()` manipulator per cell), then with the renderer in 24-bit
+//! and 256-color modes, on one thread and on all of them.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "termcolor/termcolor.hpp"
+#include "termcolor/image.hpp"
+
+using namespace termcolor;
+
+//! Smooth gradients with flat bands and some noise, to look like a photo
+//! with a sky and a few objects rather than like random pixels.
+static std::vector<uint8_t> sample(size_t width, size_t height)
+{
+    std::vector<uint8_t> pixels(width * height * 3);
+    uint32_t seed = 12345;
+    for (size_t y = 0; y < height; ++y)
+        for (size_t x = 0; x < width; ++x)
+        {
+            uint8_t* p = &pixels[(y * width + x) * 3];
+            seed = seed * 1103515245 + 12345;
+            int noise = static_cast<int>(seed >> 28) - 8;
+
+            if (y < height / 3)
+            {
+                p[0] = static_cast<uint8_t>(60 + y * 60 / height);
+                p[1] = static_cast<uint8_t>(120 + y * 60 / height);
+                p[2] = 230;
+            }
+            else if ((x / 240 + y / 240) % 3 == 0)
+            {
+                p[0] = 200;
+                p[1] = 40;
+                p[2] = 40;
+            }
+            else
+            {
+                p[0] = static_cast<uint8_t>(std::min(255, std::max(0, static_cast<int>(x * 255 / width) + noise)));
+                p[1] = static_cast<uint8_t>(std::min(255, std::max(0, static_cast<int>(y * 255 / height) + noise)));
+                p[2] = 90;
+            }
+        }
+    return pixels;
+}
+
+static void report(char const* name, size_t bytes, std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "image " << name << ": " << (static_cast<double>(bytes) / (1 << 20)) << " MiB in "
+              << elapsed.count() << " s" << std::endl;
+}
+
+int main()
+{
+    size_t const width = 3840, height = 2160;
+    std::vector<uint8_t> pixels = sample(width, height);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        std::ostringstream out;
+        out << colorize;
+        for (size_t y = 0; y < height; y += 2)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                uint8_t const* top = &pixels[(y * width + x) * 3];
+                uint8_t const* bottom = top + width * 3;
+                out << color(top[0], top[1], top[2]) << on_color(bottom[0], bottom[1], bottom[2]) << "\xe2\x96\x80";
+            }
+            out << reset << '\n';
+        }
+        report("naive", out.str().size(), start);
+    }
+
+    unsigned const threads[] = { 1, 0 };
+    char const* const thread_names[] = { "1 thread", "all threads" };
+    for (int mode = 0; mode < 2; ++mode)
+        for (int t = 0; t < 2; ++t)
+        {
+            image_renderer renderer;
+            renderer.mode(mode ? image_renderer::palette256 : image_renderer::truecolor).threads(threads[t]);
+
+            std::string out;
+            start = std::chrono::steady_clock::now();
+            renderer.render(out, &pixels[0], width, height);
+            std::string name = std::string(mode ? "256 colors, " : "24-bit, ") + thread_names[t];
+            report(name.c_str(), out.size(), start);
+        }
+
+    return 0;
+}
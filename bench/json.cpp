@@ -0,0 +1,73 @@
+//!
+//! termcolor's json benchmark
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Measures the throughput of the streaming JSON highlighter on a large
+//! generated document, fed in 64 KiB chunks and written to a stream that
+//! discards everything.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "termcolor/termcolor.hpp"
+#include "termcolor/json.hpp"
+
+using namespace termcolor;
+
+struct null_buffer : std::streambuf
+{
+    std::streamsize xsputn(char const*, std::streamsize n) { return n; }
+    int overflow(int c) { return c; }
+};
+
+static std::string sample(size_t target)
+{
+    std::string doc = "[\n";
+    for (size_t i = 0; doc.size() < target; ++i)
+    {
+        char record[512];
+        ::snprintf(record, sizeof(record),
+            "  {\n"
+            "    \"id\": %zu,\n"
+            "    \"name\": \"user %zu \\\"quoted\\\" \\u00e9\",\n"
+            "    \"score\": %.3f,\n"
+            "    \"active\": %s,\n"
+            "    \"tags\": [\"alpha\", \"beta\", null],\n"
+            "    \"address\": {\"city\": \"Kyiv\", \"zip\": \"%05zu\"}\n"
+            "  },\n",
+            i, i, static_cast<double>(i % 1000) / 7.0, (i % 2) ? "true" : "false", i % 100000);
+        doc += record;
+    }
+    doc += "  {}\n]\n";
+    return doc;
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 256;
+    std::string doc = sample(megabytes << 20);
+
+    null_buffer sink;
+    std::ostream out(&sink);
+    out << colorize;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        json_highlighter json(out);
+        size_t const chunk = 1 << 16;
+        for (size_t i = 0; i < doc.size(); i += chunk)
+            json.feed(doc.data() + i, std::min(chunk, doc.size() - i));
+        json.finish();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "json: " << (doc.size() >> 20) << " MiB in " << elapsed.count() << " s, "
+              << (static_cast<double>(doc.size()) / (1 << 20)) / elapsed.count() << " MiB/s"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,109 @@
+//!
+//! termcolor's log index benchmark
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Writes a large colored log (with styles that span several lines), then
+//! reports how long it takes to index it, to reopen it from the sidecar,
+//! and to render random pages of 50 lines, compared with rendering a page
+//! by scanning the log from its start.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "termcolor/termcolor.hpp"
+#include "termcolor/style.hpp"
+#include "termcolor/log_index.hpp"
+
+using namespace termcolor;
+
+static void write_sample(std::string const& path, size_t target)
+{
+    std::ofstream file(path.c_str(), std::ios::binary);
+    std::ostringstream block;
+    block << colorize;
+    size_t written = 0;
+    for (size_t i = 0; written < target; ++i)
+    {
+        if (i % 100 == 0)
+            block << style().on_blue();                 // a banner over three lines
+        else if (i % 100 == 3)
+            block << reset;
+        if (i % 13 == 0)
+            block << style().bold().red() << "FAIL" << reset << " ";
+        else
+            block << style().green() << "PASS" << reset << " ";
+        block << style().bold() << "suite_" << i / 1000 << reset << "::test_" << i << " "
+              << style().dark() << (i % 977) << " ms" << reset << "\n";
+
+        if (i % 4096 == 4095)
+        {
+            std::string s = block.str();
+            file.write(s.data(), static_cast<std::streamsize>(s.size()));
+            written += s.size();
+            block.str(std::string());
+        }
+    }
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 256;
+    std::string path = "bench_log_index.log";
+    std::remove(indexed_log::sidecar_path(path).c_str());
+    write_sample(path, megabytes << 20);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t lines;
+    {
+        indexed_log log(path);
+        lines = log.lines();
+    }
+    double build = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    indexed_log log(path);
+    double reopen = seconds_since(start);
+
+    size_t const pages = 1000, page = 50;
+    std::string out;
+    uint64_t seed = 1;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pages; ++i)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        out.clear();
+        log.render(out, (seed >> 33) % lines, page);
+    }
+    double paging = seconds_since(start);
+
+    // Without checkpoints: every page is found by scanning from line 0.
+    indexed_log whole(path, uint64_t(-1), false);
+    start = std::chrono::steady_clock::now();
+    out.clear();
+    whole.render(out, lines - page, page);
+    double scanned = seconds_since(start);
+
+    double mib = static_cast<double>(log.size()) / (1 << 20);
+    std::cout << "log index: " << mib << " MiB, " << lines << " lines, " << (log.indexed_from_sidecar() ? "" : "NOT ")
+              << "reopened from sidecar\n"
+              << "  index:  " << build << " s, " << mib / build << " MiB/s\n"
+              << "  reopen: " << reopen * 1000 << " ms\n"
+              << "  pages:  " << paging / pages * 1e6 << " us per page of " << page << " lines\n"
+              << "  scan:   " << scanned * 1e6 << " us for the last page without checkpoints" << std::endl;
+
+    std::remove(path.c_str());
+    std::remove(indexed_log::sidecar_path(path).c_str());
+    return 0;
+}
@@ -0,0 +1,71 @@
+//!
+//! termcolor's logfmt benchmark
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Measures the throughput of the logfmt colorizer on generated service
+//! logs, fed in 64 KiB chunks and written to a stream that discards
+//! everything.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "termcolor/termcolor.hpp"
+#include "termcolor/logfmt.hpp"
+
+using namespace termcolor;
+
+struct null_buffer : std::streambuf
+{
+    std::streamsize xsputn(char const*, std::streamsize n) { return n; }
+    int overflow(int c) { return c; }
+};
+
+static std::string sample(size_t target)
+{
+    static char const* const levels[] = { "info", "debug", "warn", "error" };
+
+    std::string logs;
+    for (size_t i = 0; logs.size() < target; ++i)
+    {
+        char line[512];
+        ::snprintf(line, sizeof(line),
+            "ts=2017-11-20T10:%02zu:%02zu.%03zuZ level=%s msg=\"request %s\" method=GET "
+            "path=/api/v1/users/%zu status=%d duration=%zu.%zums request_id=%08zx\n",
+            i / 60 % 60, i % 60, i % 1000, levels[i % 4], (i % 4 == 3) ? "failed: \\\"timeout\\\"" : "done",
+            i % 10000, (i % 4 == 3) ? 504 : 200, i % 100, i % 10, i * 2654435761u);
+        logs += line;
+    }
+    return logs;
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 256;
+    std::string logs = sample(megabytes << 20);
+
+    null_buffer sink;
+    std::ostream out(&sink);
+    out << colorize;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        logfmt_colorizer colorizer(out);
+        colorizer.key("status", style().cyan());
+        size_t const chunk = 1 << 16;
+        for (size_t i = 0; i < logs.size(); i += chunk)
+            colorizer.feed(logs.data() + i, std::min(chunk, logs.size() - i));
+        colorizer.finish();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "logfmt: " << (logs.size() >> 20) << " MiB in " << elapsed.count() << " s, "
+              << (static_cast<double>(logs.size()) / (1 << 20)) / elapsed.count() << " MiB/s"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,63 @@
+//!
+//! termcolor's minify benchmark
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Generates a large log the way older code writes it, with `style` and
+//! the manipulators piecemeal (a reset and a sequence per attribute before
+//! every token), minifies it in 64 KiB chunks and reports the sizes and
+//! the throughput.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "termcolor/termcolor.hpp"
+#include "termcolor/style.hpp"
+#include "termcolor/minify.hpp"
+
+using namespace termcolor;
+
+static std::string sample(size_t target)
+{
+    style const level = style().bold().red(), ok = style().green(), name = style().bold(), time = style().dark();
+    std::ostringstream log;
+    log << colorize;
+    for (size_t i = 0; static_cast<size_t>(log.tellp()) < target; ++i)
+    {
+        bool failed = i % 13 == 0;
+        log << (failed ? level : ok) << (failed ? "FAIL" : "PASS") << reset << " "
+            << name << "suite_" << i / 1000 << reset << "::" << name << "test_" << i << reset << " "
+            << time << (i % 977) << " ms" << reset << "\n";
+    }
+    return log.str();
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 128;
+    std::string log = sample(megabytes << 20);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    sgr_minifier minifier;
+    std::string out;
+    size_t written = 0;
+    size_t const chunk = 1 << 16;
+    for (size_t i = 0; i < log.size(); i += chunk)
+    {
+        minifier.feed(log.data() + i, std::min(chunk, log.size() - i), out);
+        written += out.size();
+        out.clear();
+    }
+    minifier.finish(out);
+    written += out.size();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double in_mib = static_cast<double>(log.size()) / (1 << 20), out_mib = static_cast<double>(written) / (1 << 20);
+    std::cout << "minify: " << in_mib << " MiB -> " << out_mib << " MiB (" << 100 * (1 - out_mib / in_mib)
+              << "% smaller) in " << elapsed << " s, " << in_mib / elapsed << " MiB/s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+//!
+//! termcolor's mux benchmark
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Runs 500 children at once (this same program, in child mode), each
+//! writing colored test results a line per write, merges them through
+//! pipes and through ptys into /dev/null, and reports the throughput and
+//! how many lines every write to the output carried.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "termcolor/termcolor.hpp"
+#include "termcolor/style.hpp"
+#include "termcolor/mux.hpp"
+
+using namespace termcolor;
+
+static int child(int id, int lines)
+{
+    std::ostringstream line;
+    line << colorize;
+    for (int i = 0; i < lines; ++i)
+    {
+        line.str(std::string());
+        bool failed = (id + i) % 13 == 0;
+        line << (failed ? style().bold().red() : style().green()) << (failed ? "FAIL" : "PASS") << reset
+             << " suite_" << id << "::" << style().bold() << "test_" << i << reset << " "
+             << style().dark() << (i * 7 % 977) << " ms" << reset << "\n";
+        std::string s = line.str();
+        if (::write(STDOUT_FILENO, s.data(), s.size()) < 0)
+            return 1;
+    }
+    return 0;
+}
+
+static void merge(char const* self, int children, int lines, output_mux::channel via, char const* name)
+{
+    int null = ::open("/dev/null", O_WRONLY);
+    output_mux mux(null);
+    mux.colors(true);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < children; ++i)
+    {
+        std::vector<std::string> argv;
+        argv.push_back(self);
+        argv.push_back("--child");
+        std::ostringstream id, count, tag;
+        id << i;
+        count << lines;
+        tag << "job " << i << " | ";
+        argv.push_back(id.str());
+        argv.push_back(count.str());
+        mux.spawn(argv, tag.str(), style().color(static_cast<uint8_t>(17 + i % 214)), via);
+    }
+    mux.run();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ::close(null);
+
+    int failed = 0;
+    for (size_t i = 0; i < mux.children(); ++i)
+        failed += mux.exit_status(i) != 0;
+    double mib = static_cast<double>(mux.written()) / (1 << 20);
+    std::cout << "mux (" << name << "): " << children << " children, " << mux.lines() << " lines, " << mib
+              << " MiB in " << elapsed << " s, " << mux.lines() / elapsed << " lines/s, "
+              << static_cast<double>(mux.lines()) / static_cast<double>(mux.writes()) << " lines per write"
+              << (failed ? ", SOME CHILDREN FAILED" : "") << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 4 && std::strcmp(argv[1], "--child") == 0)
+        return child(std::atoi(argv[2]), std::atoi(argv[3]));
+
+    int children = argc > 1 ? std::atoi(argv[1]) : 500;
+    int lines = argc > 2 ? std::atoi(argv[2]) : 2000;
+    merge(argv[0], children, lines, output_mux::pipe, "pipes");
+    merge(argv[0], children, lines, output_mux::pty, "ptys");
+    return 0;
+}
@@ -0,0 +1,98 @@
+//!
+//! termcolor's record benchmark
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Records a large generated ANSI test log, then replays it as ANSI, plain
+//! text and HTML and seeks into the middle of it, reporting sizes and
+//! throughput.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "termcolor/termcolor.hpp"
+#include "termcolor/record.hpp"
+
+using namespace termcolor;
+
+static std::string sample(size_t target)
+{
+    std::string log;
+    for (size_t i = 0; log.size() < target; ++i)
+    {
+        char line[256];
+        bool passed = i % 17 != 0;
+        ::snprintf(line, sizeof(line),
+            "%s\033[0m  suite_%zu::test_%zu  \033[2m%zu ms\033[0m\n",
+            passed ? "\033[32mPASS" : "\033[1;31mFAIL", i / 1000, i, i % 977);
+        log += line;
+    }
+    return log;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 128;
+    std::string log = sample(megabytes << 20);
+    double mib = static_cast<double>(log.size()) / (1 << 20);
+
+    std::ostringstream file;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        recorder rec(file);
+        size_t const chunk = 1 << 16;
+        for (size_t i = 0; i < log.size(); i += chunk)
+            rec.feed(log.data() + i, std::min(chunk, log.size() - i));
+    }
+    double elapsed = seconds_since(start);
+    std::string data = file.str();
+    std::cout << "record: " << mib << " MiB of ANSI in " << elapsed << " s, " << mib / elapsed
+              << " MiB/s, recording is " << (static_cast<double>(data.size()) / (1 << 20)) << " MiB" << std::endl;
+
+    replayer rep(data.data(), data.size());
+    char const* names[] = { "ansi", "plain", "html" };
+    for (int f = replayer::ansi; f <= replayer::html; ++f)
+    {
+        std::string out;
+        out.reserve(log.size() * 3);
+        start = std::chrono::steady_clock::now();
+        rep.render(out, static_cast<replayer::format>(f));
+        elapsed = seconds_since(start);
+        std::cout << "replay " << names[f] << ": " << (static_cast<double>(out.size()) / (1 << 20))
+                  << " MiB in " << elapsed << " s" << std::endl;
+    }
+
+    start = std::chrono::steady_clock::now();
+    std::string page;
+    for (int i = 0; i < 1000; ++i)
+    {
+        page.clear();
+        uint64_t at = rep.text_size() / 1000 * static_cast<uint64_t>(i);
+        rep.render(page, replayer::ansi, at, at + 4096);
+    }
+    std::cout << "seek: 1000 pages of 4 KiB in " << seconds_since(start) << " s" << std::endl;
+
+    // A gradient uses every style once and then again, so interning has
+    // to find styles among many.
+    std::ostringstream gradient;
+    start = std::chrono::steady_clock::now();
+    {
+        recorder rec(gradient);
+        for (int pass = 0; pass < 2; ++pass)
+            for (unsigned i = 0; i < (1u << 18); ++i)
+                rec.set_style(style().color(static_cast<uint8_t>(i >> 10), static_cast<uint8_t>(i >> 2),
+                                            static_cast<uint8_t>(i))).text("#", 1);
+    }
+    std::cout << "styles: 2 x " << (1u << 18) << " 24-bit colors recorded in " << seconds_since(start) << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,64 @@
+//!
+//! termcolor's report benchmark
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Writes a 1M-row colored test report to /dev/null, formatted with the
+//! manipulators: once through a single colorized stream, then with the
+//! parallel report builder.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include "termcolor/termcolor.hpp"
+#include "termcolor/style.hpp"
+#include "termcolor/report.hpp"
+
+using namespace termcolor;
+
+//! The formatting code under test: the same for both runs.
+static void row(std::ostream& out, size_t i)
+{
+    bool passed = i % 17 != 0;
+    out << (passed ? style().green() : style().red().bold()) << (passed ? "PASS" : "FAIL") << reset
+        << "  suite_" << (i / 1000) << "::test_" << i << "  "
+        << dark << (i % 977) << " ms" << reset << "\n";
+}
+
+int main(int argc, char** argv)
+{
+    size_t rows = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 1000000;
+    size_t const rows_per_chunk = 4096;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        std::ofstream out("/dev/null");
+        out << colorize;
+        for (size_t i = 0; i < rows; ++i)
+            row(out, i);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "report, one stream: " << rows << " rows in " << elapsed.count() << " s" << std::endl;
+
+    int fd = ::open("/dev/null", O_WRONLY);
+    report_builder report(fd);
+    report.colors(true);
+
+    start = std::chrono::steady_clock::now();
+    report.run((rows + rows_per_chunk - 1) / rows_per_chunk, [&](std::ostream& out, size_t chunk) {
+        for (size_t i = chunk * rows_per_chunk; i < rows && i < (chunk + 1) * rows_per_chunk; ++i)
+            row(out, i);
+    });
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "report, builder: " << rows << " rows in " << elapsed.count() << " s, "
+              << (static_cast<double>(report.written()) / (1 << 20)) << " MiB in "
+              << report.writes() << " writes, " << std::thread::hardware_concurrency() << " threads"
+              << std::endl;
+
+    ::close(fd);
+    return 0;
+}
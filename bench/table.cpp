@@ -0,0 +1,112 @@
+//!
+//! termcolor's table benchmark
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Renders a generated table of 100k rows by 20 columns of colored cells
+//! and reports the output size and time: the naive way (every render
+//! measures every cell for the column widths and writes a full escape and
+//! a reset around each cell), then with the table renderer, counting the
+//! cells added (and measured) and rendering it twice.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "termcolor/termcolor.hpp"
+#include "termcolor/table.hpp"
+
+using namespace termcolor;
+
+static size_t const rows = 100000, columns = 20;
+
+struct sample_cell
+{
+    std::string text;
+    style       s;
+};
+
+//! Status columns in a few colors, names, numbers and a few wide strings.
+static std::vector<sample_cell> sample()
+{
+    style const styles[] = { style(), style().green(), style().red().bold(), style().yellow(), style().dark() };
+    char const* const statuses[] = { "PASS", "FAIL", "SKIP", "FLAKY" };
+
+    std::vector<sample_cell> cells;
+    cells.reserve(rows * columns);
+    uint32_t seed = 12345;
+    for (size_t r = 0; r < rows; ++r)
+        for (size_t c = 0; c < columns; ++c)
+        {
+            seed = seed * 1103515245 + 12345;
+            sample_cell cell;
+            if (c % 5 == 1)
+            {
+                cell.text = statuses[seed >> 30];
+                cell.s = styles[1 + (seed >> 30)];
+            }
+            else if (c % 5 == 3)
+                cell.text = (seed >> 28) == 0 ? "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e" : "suite_" + std::to_string(r % 977);
+            else
+                cell.text = std::to_string(seed >> (16 + c % 12));
+            cells.push_back(cell);
+        }
+    return cells;
+}
+
+static void report(char const* name, size_t bytes, std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "table " << name << ": " << (static_cast<double>(bytes) / (1 << 20)) << " MiB in "
+              << elapsed.count() << " s" << std::endl;
+}
+
+int main()
+{
+    std::vector<sample_cell> cells = sample();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        std::vector<size_t> widths(columns, 0);
+        for (size_t i = 0; i < cells.size(); ++i)
+            widths[i % columns] = std::max(widths[i % columns], display_width(cells[i].text));
+
+        std::string out;
+        for (size_t i = 0; i < cells.size(); ++i)
+        {
+            size_t c = i % columns;
+            if (c)
+                out += "  ";
+            append(out, cells[i].s);
+            out += cells[i].text;
+            out += "\033[0m";
+            if (c + 1 < columns)
+                out.append(widths[c] - display_width(cells[i].text), ' ');
+            else
+                out += '\n';
+        }
+        report("naive", out.size(), start);
+    }
+
+    start = std::chrono::steady_clock::now();
+    table t;
+    for (size_t r = 0; r < rows; ++r)
+    {
+        t.row();
+        for (size_t c = 0; c < columns; ++c)
+            t.cell(cells[r * columns + c].text, cells[r * columns + c].s);
+    }
+    std::chrono::duration<double> added = std::chrono::steady_clock::now() - start;
+    std::cout << "table: " << rows * columns << " cells added and measured in " << added.count() << " s" << std::endl;
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        std::string out;
+        start = std::chrono::steady_clock::now();
+        t.render(out);
+        report(pass ? "renderer, again" : "renderer", out.size(), start);
+    }
+    return 0;
+}
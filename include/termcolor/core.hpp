@@ -0,0 +1,745 @@
+//!
+//! core
+//! ~~~~
+//!
+//! "Core" is the iostream-free part of termcolor library: colors, styles
+//! and their escape encoding. It doesn't include <iostream> and has no
+//! static initializers, so it's cheap to include anywhere and can be used
+//! with the string and file descriptor APIs without the stream
+//! integration, which lives in "termcolor.hpp" and "style.hpp".
+//! `color()`, `on_color()` and the default `style` are constexpr.
+//!
+//! Example.
+//!   std::string line;
+//!   append(line, style().red().bold());
+//!   line += "error";
+//!   append(line, style().red().bold(), style());
+//!   ::write(fd, line.data(), line.size());
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_CORE_HPP_
+#define TERMCOLOR_CORE_HPP_
+
+#include <iosfwd>
+#include <string>
+
+// 8/24-bit coloring exploits the "uint8_t" type i.e. "unsigned char". For
+// backward compatibility with pre-C++11 compilers it's better to use <stdint.h>
+// and global uint8_t than C++11's <cstdint> and scoped std::uint8_t.
+#include <stdint.h>
+#include <stddef.h>
+
+#if (__cplusplus >= 201100)
+#   define TERMCOLOR_CONSTEXPR constexpr
+#else
+#   define TERMCOLOR_CONSTEXPR
+#endif
+
+namespace termcolor
+{
+    struct __color_index_8bit
+    {
+        uint8_t index;
+        bool foreground;
+    };
+
+    struct __color_rgb_24bit
+    {
+        uint8_t red, green, blue;
+        bool foreground;
+    };
+
+    inline TERMCOLOR_CONSTEXPR
+    __color_index_8bit color(uint8_t index)
+    {
+        return { index, /* .foreground = */ true };
+    }
+
+    inline TERMCOLOR_CONSTEXPR
+    __color_rgb_24bit color(uint8_t red, uint8_t green, uint8_t blue)
+    {
+        return { red, green, blue, /* .foreground = */ true };
+    }
+
+    inline TERMCOLOR_CONSTEXPR
+    __color_index_8bit on_color(uint8_t index)
+    {
+        return { index, /* .foregound = */ false };
+    }
+
+    inline TERMCOLOR_CONSTEXPR
+    __color_rgb_24bit on_color(uint8_t red, uint8_t green, uint8_t blue)
+    {
+        return { red, green, blue, /* .foreground = */ false };
+    }
+
+    //! How many colors a terminal shows. 8-bit and 24-bit colors written to
+    //! a stream limited to fewer (see `max_colors()`) are replaced with the
+    //! nearest color it has; `colors_unknown` leaves them as they are.
+    enum color_depth
+    {   colors_unknown
+    ,   colors_16
+    ,   colors_256
+    ,   colors_24bit
+    };
+
+    //! 0xRRGGBB of a 256-color palette index, with xterm's defaults for
+    //! the first 16 colors.
+    inline
+    uint32_t palette_color(uint8_t index)
+    {
+        static uint32_t const system[16] =
+        {
+            0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd, 0x00cdcd, 0xe5e5e5,
+            0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00, 0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff,
+        };
+        if (index < 16)
+            return system[index];
+        if (index >= 232)
+        {
+            uint32_t v = 8 + 10 * (index - 232u);
+            return v << 16 | v << 8 | v;
+        }
+        unsigned i = index - 16u, r = i / 36, g = i / 6 % 6, b = i % 6;
+        struct _ { static uint32_t level(unsigned n) { return n ? 55 + 40 * n : 0; } };
+        return _::level(r) << 16 | _::level(g) << 8 | _::level(b);
+    }
+
+    //! Index of the color closest to (\a red, \a green, \a blue) among the
+    //! 6x6x6 cube and the grayscale ramp of the 256-color palette. The
+    //! first 16 colors are skipped since terminals don't agree on them.
+    inline
+    uint8_t nearest_color_index(uint8_t red, uint8_t green, uint8_t blue)
+    {
+        static uint8_t const levels[6] = { 0, 95, 135, 175, 215, 255 };
+
+        struct _
+        {
+            static int level(int v)         { return v < 48 ? 0 : v < 115 ? 1 : (v - 35) / 40; }
+            static int square(int v)        { return v * v; }
+        };
+
+        int r = _::level(red), g = _::level(green), b = _::level(blue);
+        int cube = _::square(levels[r] - red) + _::square(levels[g] - green) + _::square(levels[b] - blue);
+
+        int average = (red + green + blue) / 3;
+        int gray = average < 8 ? 0 : average > 238 ? 23 : (average - 3) / 10;
+        int value = 8 + 10 * gray;
+        int ramp = _::square(value - red) + _::square(value - green) + _::square(value - blue);
+
+        return static_cast<uint8_t>(ramp < cube ? 232 + gray : 16 + 36 * r + 6 * g + b);
+    }
+
+    //! Index (0..15) of the closest of the 16 basic colors, as xterm shows
+    //! them by default.
+    inline
+    uint8_t nearest_basic_index(uint8_t red, uint8_t green, uint8_t blue)
+    {
+        uint8_t best = 0;
+        long best_distance = -1;
+        for (uint8_t i = 0; i < 16; ++i)
+        {
+            uint32_t c = palette_color(i);
+            long dr = static_cast<long>(c >> 16 & 0xff) - red;
+            long dg = static_cast<long>(c >> 8 & 0xff) - green;
+            long db = static_cast<long>(c & 0xff) - blue;
+            long distance = dr * dr + dg * dg + db * db;
+            if (best_distance < 0 || distance < best_distance)
+            {
+                best = i;
+                best_distance = distance;
+            }
+        }
+        return best;
+    }
+
+    //! Style is a set of compatible attributes that can be applied
+    //! to the ostream updating current state.
+    class style
+    {
+        struct color_rgb_24bit
+        {
+            uint8_t foreground_red, foreground_green, foreground_blue;
+            uint8_t background_red, background_green, background_blue;
+            void clear()
+            {
+                foreground_red = foreground_green = foreground_blue = 0;
+                background_red = background_green = background_blue = 0;
+            }
+        };
+
+        //! Indexed and named colors are laid out over the RGB triplets so
+        //! that a foreground of one kind never clobbers a background of
+        //! another kind (e.g. rgb foreground with named background).
+        struct color_index_8bit
+        {
+            uint8_t foreground, __unused_1, __unused_2;
+            uint8_t background;
+        };
+
+        struct color_named_4bit
+        {
+            uint8_t foreground, __unused_1, __unused_2;
+            uint8_t background;
+        };
+
+        union colors_tag
+        {
+            color_named_4bit    named;
+            color_index_8bit    index;
+            color_rgb_24bit     rgb;
+        };
+
+        enum color_type
+        {   color_type_none
+        ,   color_type_named
+        ,   color_type_indexed
+        ,   color_type_rgb
+        };
+
+        //! Named colors share their byte with indexed ones and are the
+        //! same palette entries 0-7, so both are one kind of color.
+        static unsigned color_kind(unsigned type)
+        {
+            return type == color_type_named ? unsigned(color_type_indexed) : type;
+        }
+
+        enum color_name
+        {   color_grey
+        ,   color_red
+        ,   color_green
+        ,   color_yellow
+        ,   color_blue
+        ,   color_magenta
+        ,   color_cyan
+        ,   color_white
+        };
+
+    private:
+        colors_tag  _colors;
+        uint16_t    _foreground_type: 2;
+        uint16_t    _background_type: 2;
+        uint16_t    _reset          : 1;
+        uint16_t    _bold           : 1;
+        uint16_t    _dark           : 1;
+        uint16_t    _underline      : 1;
+        uint16_t    _blink          : 1;
+        uint16_t    _reverse        : 1;
+        uint16_t    _concealed      : 1;
+        uint16_t    __reserved      : 5;
+
+    public:
+        TERMCOLOR_CONSTEXPR style()
+            : _colors()
+            , _foreground_type(color_type_none)
+            , _background_type(color_type_none)
+            , _reset(1)
+            , _bold(0)
+            , _dark(0)
+            , _underline(0)
+            , _blink(0)
+            , _reverse(0)
+            , _concealed(0)
+            , __reserved(0)
+        {
+        }
+
+        void clear()
+        {
+            _colors.rgb.clear();
+            _foreground_type = color_type_none;
+            _background_type = color_type_none;
+            _reset           = 1;
+            _bold            = 0;
+            _dark            = 0;
+            _underline       = 0;
+            _blink           = 0;
+            _reverse         = 0;
+            _concealed       = 0;
+            __reserved       = 0;
+        }
+
+#       if (__cplusplus >= 201100)
+        style( style const& ) = default;
+        style& operator= ( style const& ) = default;
+#       endif
+
+    friend std::ostream& operator<< (std::ostream& stream, style);
+    friend bool operator== (style const&, style const&);
+    friend uint64_t style_key(style const&);
+    friend std::string& append(std::string& out, style const& style_);
+    friend std::string& append(std::string& out, style const& from, style const& to);
+
+    public:
+        style& reset    ( bool o = true ) { _reset     = o ? 1 : 0; return *this; }
+        style& bold     ( bool o = true ) { _bold      = o ? 1 : 0; return *this; }
+        style& dark     ( bool o = true ) { _dark      = o ? 1 : 0; return *this; }
+        style& underline( bool o = true ) { _underline = o ? 1 : 0; return *this; }
+        style& blink    ( bool o = true ) { _blink     = o ? 1 : 0; return *this; }
+        style& reverse  ( bool o = true ) { _reverse   = o ? 1 : 0; return *this; }
+        style& concealed( bool o = true ) { _concealed = o ? 1 : 0; return *this; }
+
+    public:
+        style& grey   () { _colors.named.foreground = color_grey    ; _foreground_type = color_type_named; return *this; }
+        style& red    () { _colors.named.foreground = color_red     ; _foreground_type = color_type_named; return *this; }
+        style& green  () { _colors.named.foreground = color_green   ; _foreground_type = color_type_named; return *this; }
+        style& yellow () { _colors.named.foreground = color_yellow  ; _foreground_type = color_type_named; return *this; }
+        style& blue   () { _colors.named.foreground = color_blue    ; _foreground_type = color_type_named; return *this; }
+        style& magenta() { _colors.named.foreground = color_magenta ; _foreground_type = color_type_named; return *this; }
+        style& cyan   () { _colors.named.foreground = color_cyan    ; _foreground_type = color_type_named; return *this; }
+        style& white  () { _colors.named.foreground = color_white   ; _foreground_type = color_type_named; return *this; }
+
+        style& on_grey   () { _colors.named.background = color_grey    ; _background_type = color_type_named; return *this; }
+        style& on_red    () { _colors.named.background = color_red     ; _background_type = color_type_named; return *this; }
+        style& on_green  () { _colors.named.background = color_green   ; _background_type = color_type_named; return *this; }
+        style& on_yellow () { _colors.named.background = color_yellow  ; _background_type = color_type_named; return *this; }
+        style& on_blue   () { _colors.named.background = color_blue    ; _background_type = color_type_named; return *this; }
+        style& on_magenta() { _colors.named.background = color_magenta ; _background_type = color_type_named; return *this; }
+        style& on_cyan   () { _colors.named.background = color_cyan    ; _background_type = color_type_named; return *this; }
+        style& on_white  () { _colors.named.background = color_white   ; _background_type = color_type_named; return *this; }
+
+        style& color   ( uint8_t i ) { _colors.index.foreground = i; _foreground_type = color_type_indexed; return *this; }
+        style& on_color( uint8_t i ) { _colors.index.background = i; _background_type = color_type_indexed; return *this; }
+
+        style& color( uint8_t red_, uint8_t green_, uint8_t blue_ )
+        {
+            _colors.rgb.foreground_red   = red_  ;
+            _colors.rgb.foreground_green = green_;
+            _colors.rgb.foreground_blue  = blue_ ;
+            _foreground_type = color_type_rgb;
+            return *this;
+        }
+
+        style& on_color( uint8_t red_, uint8_t green_, uint8_t blue_ )
+        {
+            _colors.rgb.background_red   = red_  ;
+            _colors.rgb.background_green = green_;
+            _colors.rgb.background_blue  = blue_ ;
+            _background_type = color_type_rgb;
+            return *this;
+        }
+
+        style& operator<< (const style& rhs)
+        {
+            return (*this = rhs);
+        }
+
+        //! Update the style with the parameters of an SGR escape sequence,
+        //! i.e. the "1;31" part of "\033[1;31m". It models what a terminal
+        //! displays, so unknown parameters are ignored and bright colors
+        //! (90-97, 100-107) become indexed colors 8-15.
+        style& apply(char const* params, size_t length)
+        {
+            unsigned values[32];
+            size_t count = 0;
+
+            values[0] = 0;
+            for (size_t i = 0; i < length; ++i)
+            {
+                char c = params[i];
+                if (c == ';' || c == ':')
+                {
+                    if (++count == 32)
+                        break;
+                    values[count] = 0;
+                }
+                else if (c >= '0' && c <= '9' && values[count] < 1000)
+                {
+                    values[count] = values[count] * 10 + static_cast<unsigned>(c - '0');
+                }
+            }
+            if (count < 32)
+                ++count;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                unsigned v = values[i];
+                if      (v == 0)              clear();
+                else if (v == 1)              bold();
+                else if (v == 2)              dark();
+                else if (v == 4)              underline();
+                else if (v == 5 || v == 6)    blink();
+                else if (v == 7)              reverse();
+                else if (v == 8)              concealed();
+                else if (v == 22)             bold(false).dark(false);
+                else if (v == 24)             underline(false);
+                else if (v == 25)             blink(false);
+                else if (v == 27)             reverse(false);
+                else if (v == 28)             concealed(false);
+                else if (v >= 30 && v <= 37)  { _colors.named.foreground = static_cast<uint8_t>(v - 30); _foreground_type = color_type_named; }
+                else if (v >= 40 && v <= 47)  { _colors.named.background = static_cast<uint8_t>(v - 40); _background_type = color_type_named; }
+                else if (v >= 90 && v <= 97)  color   (static_cast<uint8_t>(v - 90 + 8));
+                else if (v >= 100 && v <= 107) on_color(static_cast<uint8_t>(v - 100 + 8));
+                else if (v == 39)             _foreground_type = color_type_none;
+                else if (v == 49)             _background_type = color_type_none;
+                else if (v == 38 || v == 48)
+                {
+                    bool foreground = (v == 38);
+                    if (i + 2 < count && values[i + 1] == 5)
+                    {
+                        uint8_t index = static_cast<uint8_t>(values[i + 2]);
+                        foreground ? color(index) : on_color(index);
+                        i += 2;
+                    }
+                    else if (i + 4 < count && values[i + 1] == 2)
+                    {
+                        uint8_t r = static_cast<uint8_t>(values[i + 2]);
+                        uint8_t g = static_cast<uint8_t>(values[i + 3]);
+                        uint8_t b = static_cast<uint8_t>(values[i + 4]);
+                        foreground ? color(r, g, b) : on_color(r, g, b);
+                        i += 4;
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+            }
+            return *this;
+        }
+    };
+
+    #if (__cplusplus >= 201100)
+    static_assert( sizeof(style) == 8, "expected 8 bytes size" );
+    #endif
+
+    //! Two styles are equal if they produce the same terminal state when
+    //! applied after a reset. Unused color bytes are not compared, and a
+    //! named color equals the indexed color 0-7 it's written as.
+    inline
+    bool operator== (style const& lhs, style const& rhs)
+    {
+        if (lhs._bold      != rhs._bold     ) return false;
+        if (lhs._dark      != rhs._dark     ) return false;
+        if (lhs._underline != rhs._underline) return false;
+        if (lhs._blink     != rhs._blink    ) return false;
+        if (lhs._reverse   != rhs._reverse  ) return false;
+        if (lhs._concealed != rhs._concealed) return false;
+
+        if (style::color_kind(lhs._foreground_type) != style::color_kind(rhs._foreground_type)) return false;
+        if (style::color_kind(lhs._background_type) != style::color_kind(rhs._background_type)) return false;
+
+        switch (lhs._foreground_type)
+        {
+            case style::color_type_named:
+            case style::color_type_indexed:
+                if (lhs._colors.index.foreground != rhs._colors.index.foreground)
+                    return false;
+                break;
+            case style::color_type_rgb:
+                if (lhs._colors.rgb.foreground_red   != rhs._colors.rgb.foreground_red  ||
+                    lhs._colors.rgb.foreground_green != rhs._colors.rgb.foreground_green||
+                    lhs._colors.rgb.foreground_blue  != rhs._colors.rgb.foreground_blue )
+                    return false;
+                break;
+            default: break;
+        }
+
+        switch (lhs._background_type)
+        {
+            case style::color_type_named:
+            case style::color_type_indexed:
+                if (lhs._colors.index.background != rhs._colors.index.background)
+                    return false;
+                break;
+            case style::color_type_rgb:
+                if (lhs._colors.rgb.background_red   != rhs._colors.rgb.background_red  ||
+                    lhs._colors.rgb.background_green != rhs._colors.rgb.background_green||
+                    lhs._colors.rgb.background_blue  != rhs._colors.rgb.background_blue )
+                    return false;
+                break;
+            default: break;
+        }
+
+        return true;
+    }
+
+    inline
+    bool operator!= (style const& lhs, style const& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    //! A 64-bit key of the style: equal styles get equal keys and unequal
+    //! ones different keys, so styles can be looked up in hash maps.
+    inline
+    uint64_t style_key(style const& s)
+    {
+        uint64_t key = static_cast<uint64_t>(s._bold) | s._dark << 1 | s._underline << 2 |
+                       s._blink << 3 | s._reverse << 4 | s._concealed << 5;
+        key |= static_cast<uint64_t>(style::color_kind(s._foreground_type)) << 6;
+        key |= static_cast<uint64_t>(style::color_kind(s._background_type)) << 8;
+
+        switch (style::color_kind(s._foreground_type))
+        {
+            case style::color_type_indexed:
+                key |= static_cast<uint64_t>(s._colors.index.foreground) << 16;
+                break;
+            case style::color_type_rgb:
+                key |= static_cast<uint64_t>(s._colors.rgb.foreground_red  ) << 16 |
+                       static_cast<uint64_t>(s._colors.rgb.foreground_green) << 24 |
+                       static_cast<uint64_t>(s._colors.rgb.foreground_blue ) << 32;
+                break;
+            default: break;
+        }
+
+        switch (style::color_kind(s._background_type))
+        {
+            case style::color_type_indexed:
+                key |= static_cast<uint64_t>(s._colors.index.background) << 40;
+                break;
+            case style::color_type_rgb:
+                key |= static_cast<uint64_t>(s._colors.rgb.background_red  ) << 40 |
+                       static_cast<uint64_t>(s._colors.rgb.background_green) << 48 |
+                       static_cast<uint64_t>(s._colors.rgb.background_blue ) << 56;
+                break;
+            default: break;
+        }
+        return key;
+    }
+
+    namespace _internal
+    {
+        //! Append a decimal number without going through sprintf/locale.
+        inline
+        void append_number(std::string& out, uint64_t n)
+        {
+            char digits[20];
+            int count = 0;
+            do
+            {
+                digits[count++] = static_cast<char>('0' + n % 10);
+                n /= 10;
+            }
+            while (n);
+            while (count)
+                out += digits[--count];
+        }
+
+        //! Collects SGR parameters and merges them into a single
+        //! "\033[p1;p2;...m" sequence.
+        class sgr_builder
+        {
+            char    _buffer[96];
+            size_t  _length;
+
+        public:
+            sgr_builder() : _length(0) {}
+
+            bool empty() const { return _length == 0; }
+            size_t size() const { return _length ? _length + 3 : 0; }
+
+            void param(unsigned n)
+            {
+                if (_length)
+                    _buffer[_length++] = ';';
+                if (n >= 100) _buffer[_length++] = static_cast<char>('0' + n / 100);
+                if (n >= 10)  _buffer[_length++] = static_cast<char>('0' + n / 10 % 10);
+                _buffer[_length++] = static_cast<char>('0' + n % 10);
+            }
+
+            void flush(std::string& out) const
+            {
+                if (!_length)
+                    return;
+                out += "\033[";
+                out.append(_buffer, _length);
+                out += 'm';
+            }
+        };
+
+        //! An indexed color. The 16 basic colors get their short codes
+        //! (30-37 / 90-97, 40-47 / 100-107), which are the same palette
+        //! entries and work on 16-color terminals too.
+        inline
+        void indexed_param(sgr_builder& sgr, uint8_t index, bool foreground)
+        {
+            if (index < 8)
+                sgr.param((foreground ? 30u : 40u) + index);
+            else if (index < 16)
+                sgr.param((foreground ? 90u : 100u) + index - 8);
+            else
+            {
+                sgr.param(foreground ? 38 : 48);
+                sgr.param(5);
+                sgr.param(index);
+            }
+        }
+    } // namespace _internal
+
+    //! Append the escape sequence of the style to \a out as one merged SGR
+    //! sequence. It's the string counterpart of `stream << style_` and is
+    //! meant for renderers that build their output in a buffer. ANSI only.
+    inline
+    std::string& append(std::string& out, style const& style_)
+    {
+        _internal::sgr_builder sgr;
+
+        if (style_._reset    ) sgr.param(0);
+        if (style_._bold     ) sgr.param(1);
+        if (style_._dark     ) sgr.param(2);
+        if (style_._underline) sgr.param(4);
+        if (style_._blink    ) sgr.param(5);
+        if (style_._reverse  ) sgr.param(7);
+        if (style_._concealed) sgr.param(8);
+
+        switch (style_._foreground_type)
+        {
+            case style::color_type_named:
+                sgr.param(30 + style_._colors.named.foreground);
+                break;
+            case style::color_type_indexed:
+                _internal::indexed_param(sgr, style_._colors.index.foreground, true);
+                break;
+            case style::color_type_rgb:
+                sgr.param(38); sgr.param(2);
+                sgr.param(style_._colors.rgb.foreground_red);
+                sgr.param(style_._colors.rgb.foreground_green);
+                sgr.param(style_._colors.rgb.foreground_blue);
+                break;
+            default: break;
+        }
+
+        switch (style_._background_type)
+        {
+            case style::color_type_named:
+                sgr.param(40 + style_._colors.named.background);
+                break;
+            case style::color_type_indexed:
+                _internal::indexed_param(sgr, style_._colors.index.background, false);
+                break;
+            case style::color_type_rgb:
+                sgr.param(48); sgr.param(2);
+                sgr.param(style_._colors.rgb.background_red);
+                sgr.param(style_._colors.rgb.background_green);
+                sgr.param(style_._colors.rgb.background_blue);
+                break;
+            default: break;
+        }
+
+        sgr.flush(out);
+        return out;
+    }
+
+    //! Append the shortest SGR sequence that turns the terminal state
+    //! \a from into \a to. Both styles are treated as complete states,
+    //! i.e. as if applied after a reset, so `style()` is the default
+    //! terminal state. Nothing is appended if the states are equal.
+    inline
+    std::string& append(std::string& out, style const& from, style const& to)
+    {
+        if (from == to)
+            return out;
+
+        // The delta turns off what is gone and turns on what is new. Bold
+        // and dark share the same "off" code, so dropping one of them
+        // means re-enabling the other.
+        _internal::sgr_builder delta;
+
+        bool intensity_off = (from._bold && !to._bold) || (from._dark && !to._dark);
+        if (intensity_off)
+            delta.param(22);
+        if (to._bold && (intensity_off || !from._bold)) delta.param(1);
+        if (to._dark && (intensity_off || !from._dark)) delta.param(2);
+
+        if (from._underline != to._underline) delta.param(to._underline ? 4 : 24);
+        if (from._blink     != to._blink    ) delta.param(to._blink     ? 5 : 25);
+        if (from._reverse   != to._reverse  ) delta.param(to._reverse   ? 7 : 27);
+        if (from._concealed != to._concealed) delta.param(to._concealed ? 8 : 28);
+
+        style from_colors = from, to_colors = to;
+        from_colors._bold = from_colors._dark = from_colors._underline = 0;
+        from_colors._blink = from_colors._reverse = from_colors._concealed = 0;
+        to_colors._bold = to_colors._dark = to_colors._underline = 0;
+        to_colors._blink = to_colors._reverse = to_colors._concealed = 0;
+
+        style fg_only = to_colors;
+        fg_only._background_type = from._background_type;
+        fg_only._colors.rgb.background_red   = from._colors.rgb.background_red;
+        fg_only._colors.rgb.background_green = from._colors.rgb.background_green;
+        fg_only._colors.rgb.background_blue  = from._colors.rgb.background_blue;
+
+        if (!(from_colors == fg_only))
+        {
+            switch (to._foreground_type)
+            {
+                case style::color_type_named:
+                    delta.param(30 + to._colors.named.foreground);
+                    break;
+                case style::color_type_indexed:
+                    _internal::indexed_param(delta, to._colors.index.foreground, true);
+                    break;
+                case style::color_type_rgb:
+                    delta.param(38); delta.param(2);
+                    delta.param(to._colors.rgb.foreground_red);
+                    delta.param(to._colors.rgb.foreground_green);
+                    delta.param(to._colors.rgb.foreground_blue);
+                    break;
+                default:
+                    delta.param(39);
+                    break;
+            }
+        }
+
+        if (!(fg_only == to_colors))
+        {
+            switch (to._background_type)
+            {
+                case style::color_type_named:
+                    delta.param(40 + to._colors.named.background);
+                    break;
+                case style::color_type_indexed:
+                    _internal::indexed_param(delta, to._colors.index.background, false);
+                    break;
+                case style::color_type_rgb:
+                    delta.param(48); delta.param(2);
+                    delta.param(to._colors.rgb.background_red);
+                    delta.param(to._colors.rgb.background_green);
+                    delta.param(to._colors.rgb.background_blue);
+                    break;
+                default:
+                    delta.param(49);
+                    break;
+            }
+        }
+
+        // A reset followed by the full target state is sometimes shorter.
+        style absolute = to;
+        absolute._reset = 1;
+        std::string::size_type start = out.size();
+        append(out, absolute);
+        if (out.size() - start > delta.size())
+        {
+            out.resize(start);
+            delta.flush(out);
+        }
+        return out;
+    }
+
+    //! Example: st << color(200) << on_color(100);
+    inline
+    style& operator<< (style& st, __color_index_8bit color)
+    {
+        color.foreground
+            ? st.color   ( color.index )
+            : st.on_color( color.index )
+            ;
+        return st;
+    }
+
+    //! Example: st << color(0,100,100) << on_color(50,0,0);
+    inline
+    style& operator<< (style& st, __color_rgb_24bit rgb)
+    {
+        rgb.foreground
+            ? st.color   ( rgb.red, rgb.green, rgb.blue )
+            : st.on_color( rgb.red, rgb.green, rgb.blue )
+            ;
+        return st;
+    }
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_CORE_HPP_
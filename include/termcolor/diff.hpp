@@ -0,0 +1,754 @@
+//!
+//! diff
+//! ~~~~
+//!
+//! "Diff" extends termcolor library by adding a colored diff renderer, i.e.
+//! an object that compares two texts line by line and prints the result in
+//! unified or side-by-side layout using configurable styles.
+//!
+//! Lines are interned to integers and compared with Myers' algorithm in
+//! linear space (divide and conquer on the middle snake). Lines that occur
+//! on one side only are marked as changed up front, and the search gives up
+//! on optimality past a cost limit, so large inputs with many differences
+//! stay fast. Paired removed/added lines are compared word by word and the
+//! changed words are highlighted. Escapes are emitted only when the style
+//! actually changes.
+//!
+//! Example.
+//!   diff d;
+//!   d.context(2).labels("expected", "actual");
+//!   d.render(std::cout, expected_text, actual_text);
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_DIFF_HPP_
+#define TERMCOLOR_DIFF_HPP_
+
+#include <termcolor/style.hpp>
+#include <termcolor/width.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace termcolor
+{
+    namespace _internal
+    {
+        //! A non-owning piece of text.
+        struct span
+        {
+            char const* data;
+            size_t      size;
+        };
+
+        struct span_hash
+        {
+            size_t operator() (span const& s) const
+            {
+                // FNV-1a
+                uint64_t h = 14695981039346656037ULL;
+                for (size_t i = 0; i < s.size; ++i)
+                {
+                    h ^= static_cast<unsigned char>(s.data[i]);
+                    h *= 1099511628211ULL;
+                }
+                return static_cast<size_t>(h);
+            }
+        };
+
+        struct span_equal
+        {
+            bool operator() (span const& lhs, span const& rhs) const
+            {
+                return lhs.size == rhs.size && std::memcmp(lhs.data, rhs.data, lhs.size) == 0;
+            }
+        };
+
+        //! Maps equal pieces of text to equal integers.
+        class interner
+        {
+            std::unordered_map<span, int, span_hash, span_equal> _ids;
+
+        public:
+            int operator() (span const& s)
+            {
+                return _ids.insert(std::make_pair(s, static_cast<int>(_ids.size()))).first->second;
+            }
+
+            int size() const { return static_cast<int>(_ids.size()); }
+        };
+
+        inline
+        void split_lines(std::string const& text, std::vector<span>& lines)
+        {
+            char const* p = text.data();
+            char const* last = p + text.size();
+            while (p != last)
+            {
+                char const* eol = static_cast<char const*>(std::memchr(p, '\n', static_cast<size_t>(last - p)));
+                char const* next = eol ? eol + 1 : last;
+                span line = { p, static_cast<size_t>((eol ? eol : last) - p) };
+                lines.push_back(line);
+                p = next;
+            }
+        }
+
+        //! Words for intra-line highlighting: runs of alphanumerics, runs of
+        //! blanks and single other characters.
+        inline
+        void split_words(span const& line, std::vector<span>& words)
+        {
+            size_t i = 0;
+            while (i < line.size)
+            {
+                unsigned char c = static_cast<unsigned char>(line.data[i]);
+                size_t j = i + 1;
+                if (c == ' ' || c == '\t')
+                {
+                    while (j < line.size && (line.data[j] == ' ' || line.data[j] == '\t'))
+                        ++j;
+                }
+                else if (c == '_' || c >= 0x80 || (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'))
+                {
+                    while (j < line.size)
+                    {
+                        unsigned char d = static_cast<unsigned char>(line.data[j]);
+                        if (!(d == '_' || d >= 0x80 || (d >= '0' && d <= '9') || ((d | 0x20) >= 'a' && (d | 0x20) <= 'z')))
+                            break;
+                        ++j;
+                    }
+                }
+                span word = { line.data + i, j - i };
+                words.push_back(word);
+                i = j;
+            }
+        }
+
+        //! Myers' O((N+M)D) difference algorithm in linear space. Fills
+        //! per-element "changed" flags for both sequences.
+        class myers
+        {
+            int const*          _a;
+            int const*          _b;
+            char*               _a_changed;
+            char*               _b_changed;
+            std::vector<int>    _fv;
+            std::vector<int>    _bv;
+            int                 _cost_limit;
+
+        public:
+            static void run(std::vector<int> const& a, std::vector<int> const& b,
+                            std::vector<char>& a_changed, std::vector<char>& b_changed)
+            {
+                a_changed.assign(a.size(), 0);
+                b_changed.assign(b.size(), 0);
+
+                myers m;
+                m._a = a.empty() ? 0 : &a[0];
+                m._b = b.empty() ? 0 : &b[0];
+                m._a_changed = a_changed.empty() ? 0 : &a_changed[0];
+                m._b_changed = b_changed.empty() ? 0 : &b_changed[0];
+
+                size_t size = a.size() + b.size() + 3;
+                m._fv.resize(size + 2);
+                m._bv.resize(size + 2);
+
+                // Past this many edits a split point is taken heuristically.
+                int limit = 1;
+                while (static_cast<size_t>(limit) * limit < size)
+                    ++limit;
+                m._cost_limit = std::max(256, limit * 4);
+
+                m.compare(0, static_cast<int>(a.size()), 0, static_cast<int>(b.size()));
+            }
+
+        private:
+            void compare(int a0, int a1, int b0, int b1)
+            {
+                while (a0 < a1 && b0 < b1 && _a[a0] == _b[b0])
+                    ++a0, ++b0;
+                while (a0 < a1 && b0 < b1 && _a[a1 - 1] == _b[b1 - 1])
+                    --a1, --b1;
+
+                if (a0 == a1)
+                {
+                    for (int j = b0; j < b1; ++j)
+                        _b_changed[j] = 1;
+                    return;
+                }
+                if (b0 == b1)
+                {
+                    for (int i = a0; i < a1; ++i)
+                        _a_changed[i] = 1;
+                    return;
+                }
+
+                int x, y;
+                split(a0, a1, b0, b1, x, y);
+                compare(a0, a0 + x, b0, b0 + y);
+                compare(a0 + x, a1, b0 + y, b1);
+            }
+
+            //! Find a point (x, y), relative to (a0, b0), that an optimal
+            //! (or, past the cost limit, a good enough) edit path crosses.
+            void split(int a0, int a1, int b0, int b1, int& x_mid, int& y_mid)
+            {
+                int const* A = _a + a0;
+                int const* B = _b + b0;
+                int const N = a1 - a0;
+                int const M = b1 - b0;
+                int const max = (N + M + 1) / 2;
+                int const delta = N - M;
+                bool const odd = (delta & 1) != 0;
+
+                // Diagonal k lives at index k + off; -1 marks "not reached".
+                int const off = max + 1;
+                std::fill(_fv.begin(), _fv.begin() + 2 * off + 1, -1);
+                std::fill(_bv.begin(), _bv.begin() + 2 * off + 1, -1);
+
+                for (int d = 0; d <= max; ++d)
+                {
+                    // Forward search from the top-left corner.
+                    for (int k = -d; k <= d; k += 2)
+                    {
+                        if (k < -M || k > N)
+                            continue;
+
+                        int x = -1;
+                        if (d == 0)
+                            x = 0;
+                        if (_fv[off + k + 1] >= 0 && _fv[off + k + 1] - k <= M)
+                            x = _fv[off + k + 1];
+                        if (_fv[off + k - 1] >= 0 && _fv[off + k - 1] < N && _fv[off + k - 1] + 1 > x)
+                            x = _fv[off + k - 1] + 1;
+                        if (x < 0)
+                            continue;
+
+                        int y = x - k;
+                        while (x < N && y < M && A[x] == B[y])
+                            ++x, ++y;
+                        _fv[off + k] = x;
+
+                        int kb = delta - k;
+                        if (odd && kb >= -(d - 1) && kb <= d - 1 && _bv[off + kb] >= 0 && x + _bv[off + kb] >= N)
+                        {
+                            x_mid = x;
+                            y_mid = y;
+                            return;
+                        }
+                    }
+
+                    // Backward search from the bottom-right corner; x and y
+                    // count from the end of the sequences.
+                    for (int k = -d; k <= d; k += 2)
+                    {
+                        if (k < -M || k > N)
+                            continue;
+
+                        int x = -1;
+                        if (d == 0)
+                            x = 0;
+                        if (_bv[off + k + 1] >= 0 && _bv[off + k + 1] - k <= M)
+                            x = _bv[off + k + 1];
+                        if (_bv[off + k - 1] >= 0 && _bv[off + k - 1] < N && _bv[off + k - 1] + 1 > x)
+                            x = _bv[off + k - 1] + 1;
+                        if (x < 0)
+                            continue;
+
+                        int y = x - k;
+                        while (x < N && y < M && A[N - 1 - x] == B[M - 1 - y])
+                            ++x, ++y;
+                        _bv[off + k] = x;
+
+                        int kf = delta - k;
+                        if (!odd && kf >= -d && kf <= d && _fv[off + kf] >= 0 && x + _fv[off + kf] >= N)
+                        {
+                            x_mid = N - x;
+                            y_mid = M - y;
+                            return;
+                        }
+                    }
+
+                    if (d >= _cost_limit)
+                        break;
+                }
+
+                // Too expensive: take the furthest reaching forward point.
+                x_mid = 0;
+                y_mid = 0;
+                for (int k = -max; k <= max; ++k)
+                {
+                    int x = _fv[off + k];
+                    if (x >= 0 && x - k >= 0 && x - k <= M && 2 * x - k > x_mid + y_mid)
+                    {
+                        x_mid = x;
+                        y_mid = x - k;
+                    }
+                }
+                if ((x_mid == 0 && y_mid == 0) || (x_mid == N && y_mid == M))
+                {
+                    x_mid = N / 2;
+                    y_mid = M / 2;
+                }
+            }
+        };
+
+        //! A region where the texts differ: [a, a + a_count) was replaced
+        //! by [b, b + b_count).
+        struct change
+        {
+            size_t a, a_count;
+            size_t b, b_count;
+        };
+    } // namespace _internal
+
+    class diff
+    {
+    public:
+        enum layout
+        {   unified
+        ,   side_by_side
+        };
+
+        diff()
+            : _layout(unified)
+            , _context(3)
+            , _width(120)
+            , _words(true)
+        {
+            _added.green();
+            _removed.red();
+            _added_word.green().reverse();
+            _removed_word.red().reverse();
+            _hunk.cyan();
+            _header.bold();
+        }
+
+        diff& set_layout(layout l)          { _layout = l;       return *this; }
+        diff& context(size_t lines)         { _context = lines;  return *this; }
+        diff& width(size_t columns)         { _width = columns;  return *this; }
+        diff& words(bool highlight = true)  { _words = highlight; return *this; }
+
+        diff& labels(std::string const& from, std::string const& to)
+        {
+            _from_label = from;
+            _to_label = to;
+            return *this;
+        }
+
+        //! Styles of whole added/removed lines, of the words that differ
+        //! within paired lines, of hunk headers and of the file labels.
+        diff& added       (style const& s) { _added = s;        return *this; }
+        diff& removed     (style const& s) { _removed = s;      return *this; }
+        diff& added_word  (style const& s) { _added_word = s;   return *this; }
+        diff& removed_word(style const& s) { _removed_word = s; return *this; }
+        diff& hunk        (style const& s) { _hunk = s;         return *this; }
+        diff& header      (style const& s) { _header = s;       return *this; }
+
+        //! Append the diff of \a from and \a to to \a out. Returns false if
+        //! the texts are equal (nothing is appended then).
+        bool render(std::string& out, std::string const& from, std::string const& to, bool colors = true) const
+        {
+            std::vector<_internal::span> a, b;
+            _internal::split_lines(from, a);
+            _internal::split_lines(to, b);
+            ending ends = { ends_in_newline(from), ends_in_newline(to) };
+
+            std::vector<_internal::change> changes;
+            compare_lines(a, b, ends, changes);
+            if (changes.empty())
+                return false;
+
+            output o(out, colors);
+            if (!_from_label.empty() || !_to_label.empty())
+            {
+                if (_layout == unified)
+                {
+                    o.text(_header, "--- ");
+                    o.text(_header, _from_label.data(), _from_label.size());
+                    o.newline();
+                    o.text(_header, "+++ ");
+                    o.text(_header, _to_label.data(), _to_label.size());
+                    o.newline();
+                }
+                else
+                {
+                    std::string left, right;
+                    output l(left, colors), r(right, colors);
+                    l.text(_header, _from_label.data(), _from_label.size());
+                    r.text(_header, _to_label.data(), _to_label.size());
+                    l.close();
+                    r.close();
+                    cell(o, left, right, ' ');
+                }
+            }
+
+            size_t first = 0;
+            while (first < changes.size())
+            {
+                // Changes closer than twice the context share a hunk.
+                size_t last = first + 1;
+                while (last < changes.size() &&
+                       changes[last].a - (changes[last - 1].a + changes[last - 1].a_count) <= 2 * _context)
+                    ++last;
+                render_hunk(o, a, b, ends, changes, first, last);
+                first = last;
+            }
+            return true;
+        }
+
+        //! Print the diff to \a stream. Colors follow the stream's
+        //! colorize state, as for the manipulators.
+        bool render(std::ostream& stream, std::string const& from, std::string const& to) const
+        {
+            std::string out;
+            bool differ = render(out, from, to, _internal::is_colorized(stream));
+            stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+            return differ;
+        }
+
+    private:
+        //! Whether each text ends in a line break. A last line without one
+        //! differs from the same line with one, as for diff(1).
+        struct ending
+        {
+            bool a, b;
+        };
+
+        static bool ends_in_newline(std::string const& text)
+        {
+            return text.empty() || text[text.size() - 1] == '\n';
+        }
+
+        //! The line to compare \a line by: with its line break, if it has
+        //! one, so that a missing break at the end is a change.
+        static _internal::span with_newline(std::vector<_internal::span> const& lines, size_t i, bool ends)
+        {
+            _internal::span key = lines[i];
+            if (i + 1 < lines.size() || ends)
+                ++key.size;
+            return key;
+        }
+
+        //! Output buffer that remembers the current style, so escapes are
+        //! written only at style changes and every line ends in default.
+        class output
+        {
+            std::string&    _out;
+            bool            _colors;
+            style           _current;
+
+        public:
+            output(std::string& out, bool colors) : _out(out), _colors(colors) {}
+
+            std::string& buffer() { return _out; }
+            bool colors() const { return _colors; }
+
+            void text(style const& s, char const* p, size_t n)
+            {
+                if (_colors)
+                {
+                    append(_out, _current, s);
+                    _current = s;
+                }
+                _out.append(p, n);
+            }
+
+            void text(style const& s, char const* p)
+            {
+                text(s, p, std::strlen(p));
+            }
+
+            void plain(char const* p, size_t n)
+            {
+                text(style(), p, n);
+            }
+
+            //! Append pre-rendered text that starts and ends in the default
+            //! state.
+            void raw(std::string const& s)
+            {
+                close();
+                _out += s;
+            }
+
+            void close()
+            {
+                if (_colors)
+                {
+                    append(_out, _current, style());
+                    _current = style();
+                }
+            }
+
+            void newline()
+            {
+                close();
+                _out += '\n';
+            }
+        };
+
+        //! diff(1)'s marker after a last line without a line break.
+        static void no_newline(output& o, std::vector<_internal::span> const& lines, size_t i, bool ends)
+        {
+            static char const marker[] = "\\ No newline at end of file";
+            if (!ends && i + 1 == lines.size())
+            {
+                o.plain(marker, sizeof(marker) - 1);
+                o.newline();
+            }
+        }
+
+        void compare_lines(std::vector<_internal::span> const& a,
+                           std::vector<_internal::span> const& b,
+                           ending const& ends,
+                           std::vector<_internal::change>& changes) const
+        {
+            _internal::interner intern;
+            std::vector<int> a_ids(a.size()), b_ids(b.size());
+            for (size_t i = 0; i < a.size(); ++i) a_ids[i] = intern(with_newline(a, i, ends.a));
+            for (size_t j = 0; j < b.size(); ++j) b_ids[j] = intern(with_newline(b, j, ends.b));
+
+            // Lines present on one side only can't match anything; leave
+            // them out of the search and mark them as changed directly.
+            std::vector<unsigned char> in_a(static_cast<size_t>(intern.size()), 0);
+            std::vector<unsigned char> in_b(static_cast<size_t>(intern.size()), 0);
+            for (size_t i = 0; i < a.size(); ++i) in_a[static_cast<size_t>(a_ids[i])] = 1;
+            for (size_t j = 0; j < b.size(); ++j) in_b[static_cast<size_t>(b_ids[j])] = 1;
+
+            std::vector<int> a_kept, b_kept;
+            std::vector<size_t> a_index, b_index;
+            std::vector<char> a_changed(a.size(), 1), b_changed(b.size(), 1);
+            for (size_t i = 0; i < a.size(); ++i)
+                if (in_b[static_cast<size_t>(a_ids[i])])
+                {
+                    a_kept.push_back(a_ids[i]);
+                    a_index.push_back(i);
+                }
+            for (size_t j = 0; j < b.size(); ++j)
+                if (in_a[static_cast<size_t>(b_ids[j])])
+                {
+                    b_kept.push_back(b_ids[j]);
+                    b_index.push_back(j);
+                }
+
+            std::vector<char> a_kept_changed, b_kept_changed;
+            _internal::myers::run(a_kept, b_kept, a_kept_changed, b_kept_changed);
+            for (size_t i = 0; i < a_kept.size(); ++i) a_changed[a_index[i]] = a_kept_changed[i];
+            for (size_t j = 0; j < b_kept.size(); ++j) b_changed[b_index[j]] = b_kept_changed[j];
+
+            size_t i = 0, j = 0;
+            while (i < a.size() || j < b.size())
+            {
+                if ((i < a.size() && a_changed[i]) || (j < b.size() && b_changed[j]))
+                {
+                    _internal::change c = { i, 0, j, 0 };
+                    while (i < a.size() && a_changed[i]) ++i;
+                    while (j < b.size() && b_changed[j]) ++j;
+                    c.a_count = i - c.a;
+                    c.b_count = j - c.b;
+                    changes.push_back(c);
+                }
+                else
+                {
+                    ++i;
+                    ++j;
+                }
+            }
+        }
+
+        //! Word level comparison of a removed/added pair of lines.
+        void compare_words(_internal::span const& from, _internal::span const& to,
+                           std::vector<_internal::span>& from_words, std::vector<char>& from_changed,
+                           std::vector<_internal::span>& to_words, std::vector<char>& to_changed) const
+        {
+            _internal::split_words(from, from_words);
+            _internal::split_words(to, to_words);
+
+            _internal::interner intern;
+            std::vector<int> a(from_words.size()), b(to_words.size());
+            for (size_t i = 0; i < a.size(); ++i) a[i] = intern(from_words[i]);
+            for (size_t j = 0; j < b.size(); ++j) b[j] = intern(to_words[j]);
+            _internal::myers::run(a, b, from_changed, to_changed);
+        }
+
+        //! Write the \a line in \a base style, with changed words (if any)
+        //! in \a highlight style.
+        static void words_line(output& o, style const& base, style const& highlight,
+                               std::vector<_internal::span> const& words, std::vector<char> const& changed)
+        {
+            for (size_t i = 0; i < words.size(); ++i)
+                o.text(changed[i] ? highlight : base, words[i].data, words[i].size);
+        }
+
+        void render_hunk(output& o,
+                         std::vector<_internal::span> const& a,
+                         std::vector<_internal::span> const& b,
+                         ending const& ends,
+                         std::vector<_internal::change> const& changes,
+                         size_t first, size_t last) const
+        {
+            _internal::change const& head = changes[first];
+            _internal::change const& tail = changes[last - 1];
+
+            size_t a_begin = head.a - std::min(head.a, _context);
+            size_t b_begin = head.b - (head.a - a_begin);
+            size_t a_end = std::min(a.size(), tail.a + tail.a_count + _context);
+            size_t b_end = tail.b + tail.b_count + (a_end - tail.a - tail.a_count);
+
+            std::string header;
+            hunk_header(header, a_begin, a_end - a_begin, b_begin, b_end - b_begin);
+            o.text(_hunk, header.data(), header.size());
+            o.newline();
+
+            size_t i = a_begin, j = b_begin;
+            for (size_t c = first; c <= last; ++c)
+            {
+                // Common lines up to the next change (or the hunk end).
+                size_t until = c < last ? changes[c].a : a_end;
+                for (; i < until; ++i, ++j)
+                {
+                    if (_layout == unified)
+                    {
+                        o.plain(" ", 1);
+                        o.plain(a[i].data, a[i].size);
+                        o.newline();
+                        no_newline(o, a, i, ends.a);
+                    }
+                    else
+                    {
+                        std::string line(a[i].data, a[i].size);
+                        cell(o, line, line, ' ');
+                    }
+                }
+                if (c == last)
+                    break;
+
+                _internal::change const& ch = changes[c];
+                if (_layout == unified)
+                    unified_change(o, a, b, ends, ch);
+                else
+                    side_by_side_change(o, a, b, ch);
+                i += ch.a_count;
+                j += ch.b_count;
+            }
+        }
+
+        static void hunk_header(std::string& out, size_t a, size_t a_count, size_t b, size_t b_count)
+        {
+            out += "@@ -";
+            _internal::append_number(out, a_count ? a + 1 : a);
+            out += ',';
+            _internal::append_number(out, a_count);
+            out += " +";
+            _internal::append_number(out, b_count ? b + 1 : b);
+            out += ',';
+            _internal::append_number(out, b_count);
+            out += " @@";
+        }
+
+        void unified_change(output& o,
+                            std::vector<_internal::span> const& a,
+                            std::vector<_internal::span> const& b,
+                            ending const& ends,
+                            _internal::change const& ch) const
+        {
+            size_t pairs = _words ? std::min(ch.a_count, ch.b_count) : 0;
+            std::vector<std::vector<_internal::span> > a_words(pairs), b_words(pairs);
+            std::vector<std::vector<char> > a_changed(pairs), b_changed(pairs);
+            for (size_t k = 0; k < pairs; ++k)
+                compare_words(a[ch.a + k], b[ch.b + k], a_words[k], a_changed[k], b_words[k], b_changed[k]);
+
+            for (size_t k = 0; k < ch.a_count; ++k)
+            {
+                o.text(_removed, "-", 1);
+                if (k < pairs)
+                    words_line(o, _removed, _removed_word, a_words[k], a_changed[k]);
+                else
+                    o.text(_removed, a[ch.a + k].data, a[ch.a + k].size);
+                o.newline();
+                no_newline(o, a, ch.a + k, ends.a);
+            }
+            for (size_t k = 0; k < ch.b_count; ++k)
+            {
+                o.text(_added, "+", 1);
+                if (k < pairs)
+                    words_line(o, _added, _added_word, b_words[k], b_changed[k]);
+                else
+                    o.text(_added, b[ch.b + k].data, b[ch.b + k].size);
+                o.newline();
+                no_newline(o, b, ch.b + k, ends.b);
+            }
+        }
+
+        void side_by_side_change(output& o,
+                                 std::vector<_internal::span> const& a,
+                                 std::vector<_internal::span> const& b,
+                                 _internal::change const& ch) const
+        {
+            size_t rows = std::max(ch.a_count, ch.b_count);
+            for (size_t k = 0; k < rows; ++k)
+            {
+                std::string left, right;
+                output l(left, o.colors()), r(right, o.colors());
+
+                if (k < ch.a_count && k < ch.b_count && _words)
+                {
+                    std::vector<_internal::span> a_words, b_words;
+                    std::vector<char> a_changed, b_changed;
+                    compare_words(a[ch.a + k], b[ch.b + k], a_words, a_changed, b_words, b_changed);
+                    words_line(l, _removed, _removed_word, a_words, a_changed);
+                    words_line(r, _added, _added_word, b_words, b_changed);
+                }
+                else
+                {
+                    if (k < ch.a_count) l.text(_removed, a[ch.a + k].data, a[ch.a + k].size);
+                    if (k < ch.b_count) r.text(_added, b[ch.b + k].data, b[ch.b + k].size);
+                }
+                l.close();
+                r.close();
+
+                char marker = k >= ch.b_count ? '<' : k >= ch.a_count ? '>' : '|';
+                cell(o, left, right, marker);
+            }
+        }
+
+        //! One side-by-side row: both cells are cut or padded to half of
+        //! the width. Cells are pre-rendered and end in the default state.
+        void cell(output& o, std::string const& left, std::string const& right, char marker) const
+        {
+            size_t half = _width > 3 ? (_width - 3) / 2 : 1;
+
+            std::string l = truncate(left, half);
+            o.raw(l);
+            o.buffer().append(half - std::min(half, display_width(l)), ' ');
+
+            char middle[3] = { ' ', marker, ' ' };
+            o.plain(middle, 3);
+
+            o.raw(truncate(right, half));
+            o.newline();
+        }
+
+    private:
+        layout      _layout;
+        size_t      _context;
+        size_t      _width;
+        bool        _words;
+        std::string _from_label;
+        std::string _to_label;
+        style       _added;
+        style       _removed;
+        style       _added_word;
+        style       _removed_word;
+        style       _hunk;
+        style       _header;
+    };
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_DIFF_HPP_
@@ -0,0 +1,271 @@
+//!
+//! hexdump
+//! ~~~~~~~
+//!
+//! "Hexdump" extends termcolor library by adding a colored hex dump
+//! renderer, i.e. an object that prints binary buffers in the classic
+//! "offset, hex bytes, |ascii|" layout with bytes colored by their class
+//! (zero, printable ASCII, whitespace, control, high-bit).
+//!
+//! Bytes are classified 16 at a time with SSE2 (scalar elsewhere), escapes
+//! are precomputed per pair of classes and emitted only when the class
+//! changes, and every row goes to the stream with a single write.
+//!
+//! Example.
+//!   hexdump dump;
+//!   dump.set(hexdump::zero, style().dark());
+//!   dump.render(std::cout, buffer, size);
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_HEXDUMP_HPP_
+#define TERMCOLOR_HEXDUMP_HPP_
+
+#include <termcolor/style.hpp>
+#include <termcolor/scan.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace termcolor
+{
+    class hexdump
+    {
+    public:
+        enum byte_class
+        {   zero
+        ,   printable
+        ,   whitespace
+        ,   control
+        ,   high
+        ,   class_count
+        };
+
+        hexdump()
+            : _transitions_ready(false)
+            , _columns(16)
+        {
+            _styles[zero].dark();
+            _styles[printable].green();
+            _styles[whitespace].yellow();
+            _styles[control].red();
+            _styles[high].magenta();
+        }
+
+        //! Style used for bytes of the given class.
+        hexdump& set(byte_class c, style const& s)
+        {
+            _styles[c] = s;
+            _transitions_ready = false;
+            return *this;
+        }
+
+        //! Bytes per row, rounded to a multiple of 16 (at least 16).
+        hexdump& columns(size_t bytes)
+        {
+            _columns = bytes < 16 ? 16 : bytes / 16 * 16;
+            return *this;
+        }
+
+        //! Classify \a size bytes into \a classes, one `byte_class` each.
+        static void classify(uint8_t const* data, size_t size, uint8_t* classes)
+        {
+            size_t i = 0;
+
+        #if defined(TERMCOLOR_SSE2)
+            __m128i const v_zero    = _mm_setzero_si128();
+            __m128i const v_space   = _mm_set1_epi8(' ');
+            __m128i const v_tab_lo  = _mm_set1_epi8(0x08);
+            __m128i const v_tab_hi  = _mm_set1_epi8(0x0e);
+            __m128i const v_del     = _mm_set1_epi8(0x7f);
+            __m128i const c_print   = _mm_set1_epi8(printable);
+            __m128i const c_space   = _mm_set1_epi8(whitespace);
+            __m128i const c_control = _mm_set1_epi8(control);
+            __m128i const c_high    = _mm_set1_epi8(high);
+
+            for (; i + 16 <= size; i += 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+
+                // Signed compares: high-bit bytes are negative.
+                __m128i is_high  = _mm_cmplt_epi8(v, v_zero);
+                __m128i is_zero  = _mm_cmpeq_epi8(v, v_zero);
+                __m128i is_space = _mm_or_si128(_mm_cmpeq_epi8(v, v_space),
+                    _mm_and_si128(_mm_cmpgt_epi8(v, v_tab_lo), _mm_cmplt_epi8(v, v_tab_hi)));
+                __m128i is_print = _mm_and_si128(_mm_cmpgt_epi8(v, v_space), _mm_cmplt_epi8(v, v_del));
+                __m128i is_other = _mm_or_si128(_mm_or_si128(is_high, is_zero), _mm_or_si128(is_space, is_print));
+
+                __m128i cls = _mm_or_si128(
+                    _mm_or_si128(_mm_and_si128(is_high, c_high), _mm_and_si128(is_print, c_print)),
+                    _mm_or_si128(_mm_and_si128(is_space, c_space), _mm_andnot_si128(is_other, c_control)));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(classes + i), cls);
+            }
+        #endif
+
+            for (; i < size; ++i)
+                classes[i] = static_cast<uint8_t>(classify(data[i]));
+        }
+
+        static byte_class classify(uint8_t byte)
+        {
+            if (byte == 0)                          return zero;
+            if (byte >= 0x80)                       return high;
+            if (byte > 0x20 && byte < 0x7f)         return printable;
+            if (byte == ' ' || (byte >= 0x09 && byte <= 0x0d)) return whitespace;
+            return control;
+        }
+
+        //! Append the dump of \a size bytes to \a out. \a offset is the
+        //! address printed for the first byte.
+        void render(std::string& out, void const* data, size_t size, uint64_t offset = 0, bool colors = true)
+        {
+            uint8_t const* bytes = static_cast<uint8_t const*>(data);
+            for (size_t row = 0; row < size; row += _columns)
+            {
+                size_t n = size - row < _columns ? size - row : _columns;
+                render_row(out, bytes + row, n, offset + row, colors);
+            }
+        }
+
+        //! Print the dump to \a stream, one write per row. Colors follow the
+        //! stream's colorize state, as for the manipulators.
+        void render(std::ostream& stream, void const* data, size_t size, uint64_t offset = 0)
+        {
+            bool colors = _internal::is_colorized(stream);
+            uint8_t const* bytes = static_cast<uint8_t const*>(data);
+
+            std::string line;
+            for (size_t row = 0; row < size; row += _columns)
+            {
+                size_t n = size - row < _columns ? size - row : _columns;
+                line.clear();
+                render_row(line, bytes + row, n, offset + row, colors);
+                stream.write(line.data(), static_cast<std::streamsize>(line.size()));
+            }
+        }
+
+    private:
+        //! State `class_count` stands for the default terminal state.
+        void prepare()
+        {
+            if (_transitions_ready)
+                return;
+
+            for (int from = 0; from <= class_count; ++from)
+                for (int to = 0; to <= class_count; ++to)
+                {
+                    std::string& t = _transitions[from][to];
+                    t.clear();
+                    append(t, from == class_count ? style() : _styles[from],
+                              to   == class_count ? style() : _styles[to]);
+                }
+            _transitions_ready = true;
+        }
+
+        static char* put(char* p, std::string const& s)
+        {
+            std::memcpy(p, s.data(), s.size());
+            return p + s.size();
+        }
+
+        void render_row(std::string& out, uint8_t const* bytes, size_t n, uint64_t offset, bool colors)
+        {
+            static char const digits[] = "0123456789abcdef";
+
+            _classes.resize(_columns);
+            classify(bytes, n, &_classes[0]);
+            if (colors)
+                prepare();
+
+            // Worst case: every byte changes the class in both columns.
+            size_t longest = 0;
+            if (colors)
+                for (int from = 0; from <= class_count; ++from)
+                    for (int to = 0; to <= class_count; ++to)
+                        longest = std::max(longest, _transitions[from][to].size());
+            _row.resize(18 + _columns * (5 + 2 * longest) + _columns / 8 + 2 * longest);
+
+            char* const begin = &_row[0];
+            char* p = begin;
+
+            // Eight digits, and more from 4 GiB on.
+            int shift = 28;
+            while (shift < 60 && offset >> (shift + 4))
+                shift += 4;
+            for (; shift >= 0; shift -= 4)
+                *p++ = digits[(offset >> shift) & 0xf];
+            *p++ = ' ';
+            *p++ = ' ';
+
+            int current = class_count;
+            for (size_t i = 0; i < _columns; ++i)
+            {
+                if (i && i % 8 == 0)
+                    *p++ = ' ';
+
+                if (i >= n)
+                {
+                    if (colors && current != class_count)
+                    {
+                        p = put(p, _transitions[current][class_count]);
+                        current = class_count;
+                    }
+                    *p++ = ' ';
+                    *p++ = ' ';
+                    *p++ = ' ';
+                    continue;
+                }
+
+                if (colors && _classes[i] != current)
+                {
+                    p = put(p, _transitions[current][_classes[i]]);
+                    current = _classes[i];
+                }
+                *p++ = digits[bytes[i] >> 4];
+                *p++ = digits[bytes[i] & 0xf];
+                *p++ = ' ';
+            }
+
+            if (colors)
+            {
+                p = put(p, _transitions[current][class_count]);
+                current = class_count;
+            }
+            *p++ = ' ';
+            *p++ = '|';
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (colors && _classes[i] != current)
+                {
+                    p = put(p, _transitions[current][_classes[i]]);
+                    current = _classes[i];
+                }
+                uint8_t b = bytes[i];
+                *p++ = b >= 0x20 && b < 0x7f ? static_cast<char>(b) : '.';
+            }
+
+            if (colors)
+                p = put(p, _transitions[current][class_count]);
+            *p++ = '|';
+            *p++ = '\n';
+
+            out.append(begin, static_cast<size_t>(p - begin));
+        }
+
+    private:
+        style       _styles[class_count];
+        std::string _transitions[class_count + 1][class_count + 1];
+        bool        _transitions_ready;
+        size_t      _columns;
+        std::vector<uint8_t> _classes;
+        std::vector<char>    _row;
+    };
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_HEXDUMP_HPP_
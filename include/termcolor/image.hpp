@@ -0,0 +1,288 @@
+//!
+//! image
+//! ~~~~~
+//!
+//! "Image" extends termcolor library by adding an image renderer, i.e. an
+//! object that draws RGB pixels (decoded elsewhere, e.g. from PPM or PNG)
+//! on the terminal with half-block glyphs, two pixel rows per line.
+//!
+//! Each cell is an upper or a lower half block (or a full block, or a
+//! space when both halves have the same color), whichever needs fewer
+//! escapes given the colors already set, and an escape is emitted only
+//! when the foreground or background actually changes. Colors are written
+//! as 24-bit or quantized to the 256-color palette. Rows are rendered in
+//! parallel into per-thread buffers that are concatenated in order.
+//!
+//! Example.
+//!   image_renderer renderer;
+//!   renderer.mode(image_renderer::palette256);
+//!   renderer.render(std::cout, pixels, width, height);
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_IMAGE_HPP_
+#define TERMCOLOR_IMAGE_HPP_
+
+#include <termcolor/termcolor.hpp>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace termcolor
+{
+    class image_renderer
+    {
+        //! A color as compared and written: 0xRRGGBB or a palette index.
+        typedef uint32_t color_key;
+        static color_key const none = 0xffffffffu;
+
+    public:
+        enum color_mode
+        {   truecolor
+        ,   palette256
+        };
+
+        image_renderer()
+            : _mode(truecolor)
+            , _threads(0)
+        {
+        }
+
+        image_renderer& mode(color_mode m) { _mode = m; return *this; }
+
+        //! Number of rendering threads, 0 for one per hardware thread.
+        image_renderer& threads(unsigned n) { _threads = n; return *this; }
+
+        //! Append the image to \a out. \a pixels are RGB triplets, rows are
+        //! \a stride bytes apart (`3 * width` if 0). Every line ends with a
+        //! reset. Without colors only the layout is kept.
+        void render(std::string& out, uint8_t const* pixels, size_t width, size_t height,
+                    size_t stride = 0, bool colors = true) const
+        {
+            if (!stride)
+                stride = 3 * width;
+
+            size_t lines = (height + 1) / 2;
+            size_t workers = _threads ? _threads : std::thread::hardware_concurrency();
+            if (!workers)
+                workers = 1;
+
+            // Threads are worth starting only for a decent amount of pixels.
+            size_t const pixels_per_worker = 1 << 16;
+            if (workers > width * height / pixels_per_worker)
+                workers = width * height / pixels_per_worker;
+            if (workers > lines)
+                workers = lines;
+            if (workers < 1)
+                workers = 1;
+
+            std::vector<buffer> parts(workers);
+            std::vector<std::thread> pool;
+            for (size_t w = 0; w < workers; ++w)
+            {
+                size_t first = lines * w / workers, last = lines * (w + 1) / workers;
+                job j = { this, &parts[w], pixels, width, height, stride, first, last, colors };
+                if (w + 1 == workers)
+                    j();
+                else
+                    pool.push_back(std::thread(j));
+            }
+            for (size_t w = 0; w < pool.size(); ++w)
+                pool[w].join();
+
+            size_t total = out.size();
+            for (size_t w = 0; w < workers; ++w)
+                total += parts[w].used;
+            out.reserve(total);
+            for (size_t w = 0; w < workers; ++w)
+                out.append(parts[w].data.empty() ? 0 : &parts[w].data[0], parts[w].used);
+        }
+
+        //! Print the image to \a stream. Colors follow the stream's
+        //! colorize state, as for the manipulators.
+        void render(std::ostream& stream, uint8_t const* pixels, size_t width, size_t height,
+                    size_t stride = 0) const
+        {
+            std::string out;
+            render(out, pixels, width, height, stride, _internal::is_colorized(stream));
+            stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+        }
+
+    private:
+        struct buffer
+        {
+            buffer() : used(0) {}
+
+            char* reserve(size_t size)
+            {
+                if (used + size > data.size())
+                    data.resize(std::max(data.size() * 2, used + size));
+                return &data[used];
+            }
+
+            std::vector<char> data;
+            size_t            used;
+        };
+
+        //! Lines [first, last) of one worker.
+        struct job
+        {
+            image_renderer const*   self;
+            buffer*                 out;
+            uint8_t const*          pixels;
+            size_t                  width, height, stride, first, last;
+            bool                    colors;
+
+            void operator()() const
+            {
+                for (size_t line = first; line < last; ++line)
+                    self->render_line(*out, pixels, width, height, stride, line, colors);
+            }
+        };
+
+        color_key key(uint8_t const* rgb) const
+        {
+            if (_mode == palette256)
+                return nearest_color_index(rgb[0], rgb[1], rgb[2]);
+            return static_cast<color_key>(rgb[0]) << 16 | static_cast<color_key>(rgb[1]) << 8 | rgb[2];
+        }
+
+        static char* put_number(char* p, unsigned v)
+        {
+            if (v >= 100)
+            {
+                *p++ = static_cast<char>('0' + v / 100);
+                v %= 100;
+                *p++ = static_cast<char>('0' + v / 10);
+            }
+            else if (v >= 10)
+                *p++ = static_cast<char>('0' + v / 10);
+            *p++ = static_cast<char>('0' + v % 10);
+            return p;
+        }
+
+        //! "38;2;r;g;b", "38;5;i" or "39" (and their background twins).
+        char* put_color(char* p, bool foreground, color_key c) const
+        {
+            *p++ = foreground ? '3' : '4';
+            if (c == none)
+            {
+                *p++ = '9';
+                return p;
+            }
+            *p++ = '8';
+            *p++ = ';';
+            if (_mode == palette256)
+            {
+                *p++ = '5';
+                *p++ = ';';
+                return put_number(p, c);
+            }
+            *p++ = '2';
+            *p++ = ';';
+            p = put_number(p, c >> 16 & 0xff);
+            *p++ = ';';
+            p = put_number(p, c >> 8 & 0xff);
+            *p++ = ';';
+            return put_number(p, c & 0xff);
+        }
+
+        static char* put_glyph(char* p, char const* utf8)
+        {
+            *p++ = utf8[0];
+            *p++ = utf8[1];
+            *p++ = utf8[2];
+            return p;
+        }
+
+        void render_line(buffer& out, uint8_t const* pixels, size_t width, size_t height,
+                         size_t stride, size_t line, bool colors) const
+        {
+            static char const upper[] = "\xe2\x96\x80";     // ▀
+            static char const lower[] = "\xe2\x96\x84";     // ▄
+            static char const full[]  = "\xe2\x96\x88";     // █
+
+            // Worst case per cell: both colors change, plus the glyph.
+            char* p = out.reserve(width * 44 + 8);
+            char* const begin = p;
+
+            uint8_t const* top    = pixels + 2 * line * stride;
+            uint8_t const* bottom = 2 * line + 1 < height ? top + stride : 0;
+
+            color_key fg = none, bg = none;
+            for (size_t x = 0; x < width; ++x)
+            {
+                if (!colors)
+                {
+                    p = put_glyph(p, upper);
+                    continue;
+                }
+
+                color_key t = key(top + 3 * x);
+                color_key b = bottom ? key(bottom + 3 * x) : none;
+
+                color_key want_fg, want_bg;
+                char const* glyph;
+                if (t == b)
+                {
+                    // One color: a space on it, or a full block in it.
+                    if (bg == t)            { glyph = " ";   want_fg = fg; want_bg = t; }
+                    else if (fg == t)       { glyph = full;  want_fg = t;  want_bg = bg; }
+                    else                    { glyph = " ";   want_fg = fg; want_bg = t; }
+                }
+                else
+                {
+                    // Flip the glyph when that keeps more of the current
+                    // colors. Transparent halves only fit the background.
+                    int cost_upper = (fg != t) + (bg != b);
+                    int cost_lower = (fg != b) + (bg != t);
+                    if (b != none && cost_lower < cost_upper)
+                                            { glyph = lower; want_fg = b; want_bg = t; }
+                    else                    { glyph = upper; want_fg = t; want_bg = b; }
+                }
+
+                if (want_fg != fg || want_bg != bg)
+                {
+                    *p++ = '\033';
+                    *p++ = '[';
+                    if (want_fg != fg)
+                        p = put_color(p, true, want_fg);
+                    if (want_bg != bg)
+                    {
+                        if (want_fg != fg)
+                            *p++ = ';';
+                        p = put_color(p, false, want_bg);
+                    }
+                    *p++ = 'm';
+                    fg = want_fg;
+                    bg = want_bg;
+                }
+
+                if (glyph[0] == ' ')
+                    *p++ = ' ';
+                else
+                    p = put_glyph(p, glyph);
+            }
+
+            if (colors && (fg != none || bg != none))
+            {
+                *p++ = '\033';
+                *p++ = '[';
+                *p++ = '0';
+                *p++ = 'm';
+            }
+            *p++ = '\n';
+            out.used += static_cast<size_t>(p - begin);
+        }
+
+    private:
+        color_mode  _mode;
+        unsigned    _threads;
+    };
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_IMAGE_HPP_
@@ -0,0 +1,314 @@
+//!
+//! json
+//! ~~~~
+//!
+//! "Json" extends termcolor library by adding a streaming JSON syntax
+//! highlighter, i.e. an object that is fed with chunks of a JSON document
+//! and writes it back colored: keys, strings, numbers, literals and
+//! punctuation each get their own style.
+//!
+//! The highlighter is a SAX-style tokenizer: it never builds a document
+//! tree, keeps only the current token state and a bit per nesting level,
+//! and can be fed with arbitrarily split chunks. String bodies are skipped
+//! with a vectorized search for the next quote or backslash, and escapes
+//! are emitted only when the token class changes. Whitespace keeps the
+//! layout of the input as is.
+//!
+//! Example.
+//!   json_highlighter json(std::cout);
+//!   while (size_t n = read(fd, buffer, sizeof(buffer)))
+//!       json.feed(buffer, n);
+//!   json.finish();
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_JSON_HPP_
+#define TERMCOLOR_JSON_HPP_
+
+#include <termcolor/style.hpp>
+#include <termcolor/scan.hpp>
+
+#include <string>
+#include <vector>
+
+namespace termcolor
+{
+    class json_highlighter
+    {
+        enum state
+        {   state_outside
+        ,   state_string
+        ,   state_number
+        ,   state_literal
+        };
+
+    public:
+        enum token_class
+        {   key
+        ,   string
+        ,   number
+        ,   literal
+        ,   punctuation
+        ,   class_count
+        };
+
+        //! Colors follow the stream's colorize state, as for the
+        //! manipulators. Output is buffered and written in large blocks.
+        explicit json_highlighter(std::ostream& stream, size_t buffer_size = 1 << 16)
+            : _stream(stream)
+            , _colors(_internal::is_colorized(stream))
+            , _buffer_size(buffer_size)
+            , _pending(0)
+            , _state(state_outside)
+            , _escaped(false)
+            , _expect_key(false)
+            , _current(class_count)
+            , _transitions_ready(false)
+        {
+            _styles[key].blue().bold();
+            _styles[string].green();
+            _styles[number].cyan();
+            _styles[literal].magenta();
+            _styles[punctuation].dark();
+            _buffer.reserve(buffer_size + 64);
+        }
+
+        ~json_highlighter()
+        {
+            finish();
+        }
+
+        json_highlighter& set(token_class c, style const& s)
+        {
+            _styles[c] = s;
+            _transitions_ready = false;
+            return *this;
+        }
+
+        //! Highlight the next piece of the document. Tokens may be split
+        //! between chunks at any byte.
+        void feed(char const* p, size_t size)
+        {
+            if (_colors)
+                prepare();
+
+            char const* last = p + size;
+            _pending = p;
+            while (p != last)
+            {
+                switch (_state)
+                {
+                    case state_string:
+                        p = string_body(p, last);
+                        break;
+
+                    case state_number:
+                    case state_literal:
+                        p = scalar_body(p, last);
+                        break;
+
+                    default:
+                        p = outside(p, last);
+                        break;
+                }
+            }
+            copy(last);
+        }
+
+        void feed(std::string const& chunk)
+        {
+            feed(chunk.data(), chunk.size());
+        }
+
+        //! Restore the default style and write out everything buffered.
+        void finish()
+        {
+            if (_colors && _current != class_count)
+            {
+                prepare();
+                _buffer += _transitions[_current][class_count];
+                _current = class_count;
+            }
+            flush();
+        }
+
+    private:
+        void prepare()
+        {
+            if (_transitions_ready)
+                return;
+
+            for (int from = 0; from <= class_count; ++from)
+                for (int to = 0; to <= class_count; ++to)
+                {
+                    std::string& t = _transitions[from][to];
+                    t.clear();
+                    append(t, from == class_count ? style() : _styles[from],
+                              to   == class_count ? style() : _styles[to]);
+                }
+            _transitions_ready = true;
+        }
+
+        void flush()
+        {
+            if (_buffer.empty())
+                return;
+            _stream.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+            _buffer.clear();
+        }
+
+        //! The input is copied to the output lazily, in runs between the
+        //! points where an escape has to be inserted.
+        void copy(char const* upto)
+        {
+            _buffer.append(_pending, upto);
+            _pending = upto;
+            if (_buffer.size() >= _buffer_size)
+                flush();
+        }
+
+        //! Switch the output to class \a c right before \a p.
+        void switch_to(token_class c, char const* p)
+        {
+            if (_colors && c != _current)
+            {
+                copy(p);
+                _buffer += _transitions[_current][c];
+                _current = c;
+            }
+        }
+
+        //! Inside a string: jump to the next quote or backslash.
+        char const* string_body(char const* p, char const* last)
+        {
+            char const* q = p;
+            if (_escaped)
+            {
+                ++q;
+                _escaped = false;
+            }
+
+            while (q < last)
+            {
+                q = _internal::find_any(q, last, '"', '\\');
+                if (q == last)
+                    break;
+
+                if (*q == '\\')
+                {
+                    if (q + 1 == last)
+                    {
+                        _escaped = true;
+                        q = last;
+                        break;
+                    }
+                    q += 2;
+                    continue;
+                }
+
+                _state = state_outside;
+                return q + 1;
+            }
+
+            return last;
+        }
+
+        static bool is_scalar_char(char c)
+        {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+                || c == '-' || c == '+' || c == '.';
+        }
+
+        //! Inside a number or a literal (true, false, null).
+        char const* scalar_body(char const* p, char const* last)
+        {
+            char const* q = p;
+            while (q != last && is_scalar_char(*q))
+                ++q;
+            if (q != last)
+                _state = state_outside;
+            return q;
+        }
+
+        //! Between tokens: whitespace, punctuation or the start of a value.
+        char const* outside(char const* p, char const* last)
+        {
+            char c = *p;
+            switch (c)
+            {
+                case ' ': case '\t': case '\n': case '\r':
+                    // Whitespace takes any color, so it never switches.
+                    return _internal::skip_any(p + 1, last, ' ', '\t', '\n', '\r');
+
+                case '"':
+                    switch_to(_expect_key ? key : string, p);
+                    _state = state_string;
+                    return p + 1;
+
+                case '{':
+                    _nesting.push_back(true);
+                    _expect_key = true;
+                    break;
+
+                case '[':
+                    _nesting.push_back(false);
+                    _expect_key = false;
+                    break;
+
+                case '}':
+                case ']':
+                    if (!_nesting.empty())
+                        _nesting.pop_back();
+                    _expect_key = false;
+                    break;
+
+                case ',':
+                    _expect_key = !_nesting.empty() && _nesting.back();
+                    break;
+
+                case ':':
+                    _expect_key = false;
+                    break;
+
+                default:
+                    if ((c >= '0' && c <= '9') || c == '-')
+                    {
+                        switch_to(number, p);
+                        _state = state_number;
+                        return p;
+                    }
+                    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+                    {
+                        switch_to(literal, p);
+                        _state = state_literal;
+                        return p;
+                    }
+                    break;
+            }
+
+            switch_to(punctuation, p);
+            return p + 1;
+        }
+
+    private:
+        std::ostream&   _stream;
+        bool            _colors;
+        size_t          _buffer_size;
+        std::string     _buffer;
+        char const*     _pending;
+
+        state           _state;
+        bool            _escaped;
+        bool            _expect_key;
+        std::vector<bool> _nesting;     // a bit per level, set for objects
+
+        int             _current;
+        style           _styles[class_count];
+        std::string     _transitions[class_count + 1][class_count + 1];
+        bool            _transitions_ready;
+    };
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_JSON_HPP_
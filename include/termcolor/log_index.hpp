@@ -0,0 +1,416 @@
+//!
+//! log_index
+//! ~~~~~~~~~
+//!
+//! "Log index" extends termcolor library by adding a reader of huge colored
+//! logs, i.e. an object that maps a log file into memory, indexes its
+//! lines together with the style active at them, and renders any range of
+//! lines with the right colors without reading what comes before it.
+//!
+//! The colors at a line depend on every escape before it, so the index is
+//! built in one pass over the whole file: line breaks and escapes are
+//! found together 16 bytes at a time (see "scan.hpp") and SGR sequences
+//! are applied to a `style` as they go by. Every so many lines a
+//! checkpoint keeps the line's file offset and the active style. A range
+//! is rendered from the nearest checkpoint before it, opening the style
+//! active there and closing whatever is active at its end, so it takes
+//! time proportional to the range (plus at most one checkpoint interval),
+//! not to the file.
+//!
+//! The index is saved next to the log (as "<log>.tcidx") and loaded
+//! instead of rescanning when the log's size and modification time still
+//! match, so reopening is instant.
+//!
+//! Example.
+//!   indexed_log log("build.log");
+//!   std::string page;
+//!   log.render(page, log.lines() / 2, 50);  // 50 lines from the middle
+//!   std::cout.write(page.data(), page.size());
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_LOG_INDEX_HPP_
+#define TERMCOLOR_LOG_INDEX_HPP_
+
+#include <termcolor/core.hpp>
+#include <termcolor/scan.hpp>
+
+#if defined(__unix__) || defined(__unix) || defined(__APPLE__)
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace termcolor
+{
+    namespace _internal
+    {
+        //! First bytes of a sidecar: "TCLIX" and the format version.
+        static char const log_index_magic[8] = { 'T', 'C', 'L', 'I', 'X', '\0', '\1', '\n' };
+    }
+
+    class indexed_log
+    {
+        struct checkpoint
+        {
+            uint64_t    offset;
+            style       s;
+        };
+
+    public:
+        //! Open and index the log at \a path, with a checkpoint every
+        //! \a interval lines. With \a persist the index is loaded from and
+        //! saved to `sidecar_path(path)`.
+        explicit indexed_log(std::string const& path, uint64_t interval = 1024, bool persist = true)
+            : _fd(-1)
+            , _data(0)
+            , _size(0)
+            , _modified_seconds(0)
+            , _modified_nanoseconds(0)
+            , _interval(interval ? interval : 1)
+            , _lines(0)
+            , _from_sidecar(false)
+        {
+            _fd = ::open(path.c_str(), O_RDONLY);
+            if (_fd < 0)
+                return;
+
+            struct stat info;
+            if (::fstat(_fd, &info) != 0)
+            {
+                close();
+                return;
+            }
+            _size = static_cast<uint64_t>(info.st_size);
+        #if defined(__APPLE__)
+            _modified_seconds     = static_cast<int64_t>(info.st_mtimespec.tv_sec);
+            _modified_nanoseconds = static_cast<int64_t>(info.st_mtimespec.tv_nsec);
+        #else
+            _modified_seconds     = static_cast<int64_t>(info.st_mtim.tv_sec);
+            _modified_nanoseconds = static_cast<int64_t>(info.st_mtim.tv_nsec);
+        #endif
+
+            if (_size)
+            {
+                void* mapped = ::mmap(0, static_cast<size_t>(_size), PROT_READ, MAP_PRIVATE, _fd, 0);
+                if (mapped == MAP_FAILED)
+                {
+                    close();
+                    return;
+                }
+                _data = static_cast<char const*>(mapped);
+            }
+
+            if (persist && load_index(sidecar_path(path)))
+            {
+                _from_sidecar = true;
+                return;
+            }
+            build();
+            if (persist)
+                save_index(sidecar_path(path));
+        }
+
+        ~indexed_log()
+        {
+            close();
+        }
+
+        static std::string sidecar_path(std::string const& path)
+        {
+            return path + ".tcidx";
+        }
+
+        bool is_open() const { return _fd >= 0; }
+
+        //! Bytes and lines of the log. A last line without a line break
+        //! counts too.
+        uint64_t size()  const { return _size; }
+        uint64_t lines() const { return _lines; }
+
+        //! Whether the index was loaded rather than built.
+        bool indexed_from_sidecar() const { return _from_sidecar; }
+
+        //! The style active at the start of \a line.
+        style style_at(uint64_t line) const
+        {
+            char const* p;
+            style s;
+            if (!seek(line, p, s))
+                return style();
+            return s;
+        }
+
+        //! Append \a count lines from \a first to \a out. With colors the
+        //! range starts by opening the style active at \a first and ends
+        //! in the default state; without, escapes are left out.
+        void render(std::string& out, uint64_t first, uint64_t count, bool colors = true) const
+        {
+            char const* p;
+            style s;
+            if (!count || !seek(first, p, s))
+                return;
+
+            char const* last = _data + _size;
+            char const* begin = p;
+            uint64_t left = count;
+            if (colors)
+            {
+                append(out, style(), s);
+                while (p != last && left)
+                {
+                    p = _internal::find_any(p, last, '\n', '\033');
+                    if (p == last)
+                        break;
+                    if (*p == '\n')
+                    {
+                        ++p;
+                        --left;
+                        continue;
+                    }
+                    p += apply_escape(p, last, s);
+                }
+                out.append(begin, p);
+                append(out, s, style());
+                return;
+            }
+
+            while (p != last && left)
+            {
+                char const* q = _internal::find_any(p, last, '\n', '\033');
+                out.append(p, q);
+                if (q == last)
+                    break;
+                if (*q == '\n')
+                {
+                    out += '\n';
+                    p = q + 1;
+                    --left;
+                    continue;
+                }
+                p = q + _internal::escape_length(q, last);
+            }
+        }
+
+        //! Write the index to \a path. Returns false on failure.
+        bool save_index(std::string const& path) const
+        {
+            std::string index(_internal::log_index_magic, sizeof(_internal::log_index_magic));
+            put(index, _size);
+            put(index, static_cast<uint64_t>(_modified_seconds));
+            put(index, static_cast<uint64_t>(_modified_nanoseconds));
+            put(index, _interval);
+            put(index, _lines);
+            put(index, _checkpoints.size());
+            for (size_t i = 0; i < _checkpoints.size(); ++i)
+            {
+                // SGR parameters rather than the style's bytes, which
+                // depend on the compiler's bit-field layout.
+                std::string sgr;
+                append(sgr, _checkpoints[i].s);
+                size_t length = sgr.size() > 3 ? sgr.size() - 3 : 0;
+                put(index, _checkpoints[i].offset);
+                index += static_cast<char>(length);
+                if (length)
+                    index.append(sgr, 2, length);
+            }
+
+            // Written aside and renamed, so a reader never sees half of it.
+            std::string temporary = path + ".tmp";
+            std::FILE* file = std::fopen(temporary.c_str(), "wb");
+            if (!file)
+                return false;
+            bool ok = std::fwrite(index.data(), 1, index.size(), file) == index.size();
+            ok = std::fclose(file) == 0 && ok;
+            if (ok)
+                ok = std::rename(temporary.c_str(), path.c_str()) == 0;
+            if (!ok)
+                std::remove(temporary.c_str());
+            return ok;
+        }
+
+    private:
+        indexed_log(indexed_log const&);
+        indexed_log& operator= (indexed_log const&);
+
+        void close()
+        {
+            if (_data)
+                ::munmap(const_cast<char*>(_data), static_cast<size_t>(_size));
+            if (_fd >= 0)
+                ::close(_fd);
+            _data = 0;
+            _fd = -1;
+        }
+
+        //! Apply the escape at \a p if it's SGR; returns its length.
+        static size_t apply_escape(char const* p, char const* last, style& s)
+        {
+            size_t length = _internal::escape_length(p, last);
+            if (_internal::is_sgr(p, length))
+                s.apply(p + 2, length - 3);
+            return length;
+        }
+
+        void build()
+        {
+            _checkpoints.clear();
+            checkpoint start = { 0, style() };
+            _checkpoints.push_back(start);
+
+            style s;
+            uint64_t line = 0;
+            char const* p = _data;
+            char const* last = _data + _size;
+        #if defined(MADV_SEQUENTIAL)
+            if (_size)
+                ::madvise(const_cast<char*>(_data), static_cast<size_t>(_size), MADV_SEQUENTIAL);
+        #endif
+            while (p != last)
+            {
+                p = _internal::find_any(p, last, '\n', '\033');
+                if (p == last)
+                    break;
+                if (*p == '\033')
+                {
+                    p += apply_escape(p, last, s);
+                    continue;
+                }
+
+                ++p;
+                if (++line % _interval == 0 && p != last)
+                {
+                    checkpoint c = { static_cast<uint64_t>(p - _data), s };
+                    _checkpoints.push_back(c);
+                }
+            }
+            _lines = line + (_size && _data[_size - 1] != '\n' ? 1 : 0);
+        #if defined(MADV_RANDOM)
+            if (_size)
+                ::madvise(const_cast<char*>(_data), static_cast<size_t>(_size), MADV_RANDOM);
+        #endif
+        }
+
+        //! Find the start of \a line and the style active there, from the
+        //! checkpoint before it.
+        bool seek(uint64_t line, char const*& p, style& s) const
+        {
+            if (line >= _lines)
+                return false;
+
+            checkpoint const& c = _checkpoints[static_cast<size_t>(line / _interval)];
+            p = _data + c.offset;
+            s = c.s;
+
+            char const* last = _data + _size;
+            for (uint64_t left = line % _interval; left; )
+            {
+                p = _internal::find_any(p, last, '\n', '\033');
+                if (p == last)
+                    return false;
+                if (*p == '\n')
+                {
+                    ++p;
+                    --left;
+                }
+                else
+                    p += apply_escape(p, last, s);
+            }
+            return true;
+        }
+
+        bool load_index(std::string const& path)
+        {
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (!file)
+                return false;
+            std::string index;
+            char buffer[1 << 16];
+            for (size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) > 0; )
+                index.append(buffer, n);
+            std::fclose(file);
+
+            char const* p = index.data();
+            char const* last = p + index.size();
+            size_t const magic = sizeof(_internal::log_index_magic);
+            if (index.size() < magic || std::memcmp(p, _internal::log_index_magic, magic) != 0)
+                return false;
+            p += magic;
+
+            uint64_t size, seconds, nanoseconds, interval, lines, count;
+            if (!get(p, last, size) || !get(p, last, seconds) || !get(p, last, nanoseconds) ||
+                !get(p, last, interval) || !get(p, last, lines) || !get(p, last, count))
+                return false;
+            if (size != _size || seconds != static_cast<uint64_t>(_modified_seconds) ||
+                nanoseconds != static_cast<uint64_t>(_modified_nanoseconds) || interval != _interval)
+                return false;
+
+            // The counts are checked against what the file can hold before
+            // anything is allocated for them: a line takes a byte at least,
+            // a checkpoint 9 bytes of the sidecar.
+            if (lines > _size || count > static_cast<uint64_t>(last - p) / 9 ||
+                count != (lines ? (lines - 1) / interval + 1 : 1))
+                return false;
+
+            std::vector<checkpoint> checkpoints;
+            checkpoints.reserve(static_cast<size_t>(count));
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                checkpoint c;
+                if (!get(p, last, c.offset) || p == last)
+                    return false;
+                size_t length = static_cast<uint8_t>(*p++);
+                if (length > static_cast<size_t>(last - p) || c.offset > _size ||
+                    (i && c.offset <= checkpoints.back().offset))
+                    return false;
+                c.s.apply(p, length);
+                p += length;
+                checkpoints.push_back(c);
+            }
+
+            _checkpoints.swap(checkpoints);
+            _lines = lines;
+            return true;
+        }
+
+        static void put(std::string& out, uint64_t v)
+        {
+            for (int i = 0; i < 8; ++i)
+                out += static_cast<char>(v >> (8 * i) & 0xff);
+        }
+
+        static bool get(char const*& p, char const* last, uint64_t& v)
+        {
+            if (last - p < 8)
+                return false;
+            v = 0;
+            for (int i = 0; i < 8; ++i)
+                v |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+            p += 8;
+            return true;
+        }
+
+    private:
+        int                         _fd;
+        char const*                 _data;
+        uint64_t                    _size;
+        int64_t                     _modified_seconds;
+        int64_t                     _modified_nanoseconds;
+        uint64_t                    _interval;
+        uint64_t                    _lines;
+        bool                        _from_sidecar;
+        std::vector<checkpoint>     _checkpoints;
+    };
+
+} // namespace termcolor
+
+#endif // __unix__ || __unix || __APPLE__
+
+#endif // TERMCOLOR_LOG_INDEX_HPP_
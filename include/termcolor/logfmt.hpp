@@ -0,0 +1,384 @@
+//!
+//! logfmt
+//! ~~~~~~
+//!
+//! "Logfmt" extends termcolor library by adding a streaming colorizer of
+//! logfmt (key=value) structured logs, i.e. an object that is fed with
+//! chunks of log output and writes it back with keys, values, quoted
+//! strings and level fields colored.
+//!
+//! Each line is tokenized in a single pass. Values of the level key
+//! (error, warn, info, debug, ...) and of chosen keys get their own
+//! styles. The input is copied to the output in runs, escapes are inserted
+//! only where the style actually changes and every line ends in the
+//! default state.
+//!
+//! Example.
+//!   logfmt_colorizer logs(std::cout);
+//!   logs.key("status", style().cyan());
+//!   logs.feed("level=error msg=\"disk full\" status=507\n");
+//!   logs.finish();
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_LOGFMT_HPP_
+#define TERMCOLOR_LOGFMT_HPP_
+
+#include <termcolor/style.hpp>
+#include <termcolor/scan.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace termcolor
+{
+    class logfmt_colorizer
+    {
+        //! Style ids. Fixed ones come first, then the configured level
+        //! values, then the configured keys.
+        enum
+        {   id_default
+        ,   id_key
+        ,   id_value
+        ,   id_quoted
+        ,   id_fixed_count
+        };
+
+        struct named_style
+        {
+            std::string name;
+            style       look;
+        };
+
+    public:
+        //! Colors follow the stream's colorize state, as for the
+        //! manipulators. Output is buffered and written in large blocks.
+        explicit logfmt_colorizer(std::ostream& stream, size_t buffer_size = 1 << 16)
+            : _stream(stream)
+            , _colors(_internal::is_colorized(stream))
+            , _used(0)
+            , _level_key("level")
+            , _pending(0)
+            , _current(id_default)
+            , _count(0)
+            , _transitions_ready(false)
+        {
+            _styles[id_key].dark();
+            _styles[id_quoted].green();
+
+            level("error", style().red().bold());
+            level("err",   style().red().bold());
+            level("fatal", style().red().bold().reverse());
+            level("warn",  style().yellow());
+            level("warning", style().yellow());
+            level("info",  style().green());
+            level("debug", style().blue());
+            level("trace", style().dark());
+
+            _buffer.resize(buffer_size);
+        }
+
+        ~logfmt_colorizer()
+        {
+            finish();
+        }
+
+        logfmt_colorizer& keys  (style const& s) { _styles[id_key]    = s; _transitions_ready = false; return *this; }
+        logfmt_colorizer& values(style const& s) { _styles[id_value]  = s; _transitions_ready = false; return *this; }
+        logfmt_colorizer& quoted(style const& s) { _styles[id_quoted] = s; _transitions_ready = false; return *this; }
+
+        //! Name of the key whose values are levels ("level" by default).
+        logfmt_colorizer& level_key(std::string const& name)
+        {
+            _level_key = name;
+            return *this;
+        }
+
+        //! Style of a level value. Matching is case-insensitive.
+        logfmt_colorizer& level(std::string const& value, style const& s)
+        {
+            set(_levels, value, s);
+            _transitions_ready = false;
+            return *this;
+        }
+
+        //! Style of the values of a chosen key.
+        logfmt_colorizer& key(std::string const& name, style const& s)
+        {
+            set(_keys, name, s);
+            _transitions_ready = false;
+            return *this;
+        }
+
+        //! Colorize the next piece of log output. Lines may be split
+        //! between chunks; an incomplete last line is kept until its end
+        //! arrives (or `finish()` is called).
+        void feed(char const* p, size_t size)
+        {
+            if (_colors)
+                prepare();
+
+            char const* last = p + size;
+
+            if (!_partial.empty())
+            {
+                char const* eol = static_cast<char const*>(std::memchr(p, '\n', size));
+                if (!eol)
+                {
+                    _partial.append(p, last);
+                    return;
+                }
+                _partial.append(p, eol + 1);
+                p = eol + 1;
+                lines(_partial.data(), _partial.data() + _partial.size());
+                _partial.clear();
+            }
+
+            char const* end = last;
+            while (end != p && end[-1] != '\n')
+                --end;
+            lines(p, end);
+            _partial.assign(end, last);
+        }
+
+        void feed(std::string const& chunk)
+        {
+            feed(chunk.data(), chunk.size());
+        }
+
+        //! Colorize the incomplete last line, if any, and write out
+        //! everything buffered.
+        void finish()
+        {
+            if (!_partial.empty())
+            {
+                if (_colors)
+                    prepare();
+                lines(_partial.data(), _partial.data() + _partial.size());
+                _partial.clear();
+            }
+            flush();
+        }
+
+    private:
+        static void set(std::vector<named_style>& list, std::string const& name, style const& s)
+        {
+            for (size_t i = 0; i < list.size(); ++i)
+                if (list[i].name == name)
+                {
+                    list[i].look = s;
+                    return;
+                }
+            named_style entry = { name, s };
+            list.push_back(entry);
+        }
+
+        style const& style_of(size_t id) const
+        {
+            if (id < id_fixed_count)
+                return _styles[id];
+            id -= id_fixed_count;
+            if (id < _levels.size())
+                return _levels[id].look;
+            return _keys[id - _levels.size()].look;
+        }
+
+        void prepare()
+        {
+            size_t count = id_fixed_count + _levels.size() + _keys.size();
+            if (_transitions_ready && _transitions.size() == count * count)
+                return;
+
+            _count = count;
+            _transitions.assign(count * count, std::string());
+            for (size_t from = 0; from < count; ++from)
+                for (size_t to = 0; to < count; ++to)
+                {
+                    std::string& t = _transitions[from * count + to];
+                    append(t, style_of(from), style_of(to));
+                }
+            _transitions_ready = true;
+        }
+
+        void flush()
+        {
+            if (!_used)
+                return;
+            _stream.write(&_buffer[0], static_cast<std::streamsize>(_used));
+            _used = 0;
+        }
+
+        //! Make room for \a size more bytes of output. Text is copied in
+        //! one piece at every style switch, which makes room for it and the
+        //! transition first (a line may switch styles at every byte).
+        void reserve(size_t size)
+        {
+            if (_used + size <= _buffer.size())
+                return;
+            flush();
+            if (size > _buffer.size())
+                _buffer.resize(size);
+        }
+
+        void copy(char const* upto)
+        {
+            size_t size = static_cast<size_t>(upto - _pending);
+            std::memcpy(&_buffer[_used], _pending, size);
+            _used += size;
+            _pending = upto;
+        }
+
+        void switch_to(size_t id, char const* p)
+        {
+            if (_colors && id != _current)
+            {
+                std::string const& t = _transitions[_current * _count + id];
+                reserve(static_cast<size_t>(p - _pending) + t.size());
+                copy(p);
+                std::memcpy(&_buffer[_used], t.data(), t.size());
+                _used += t.size();
+                _current = id;
+            }
+        }
+
+        static bool equal_nocase(char const* p, size_t n, std::string const& name)
+        {
+            if (n != name.size())
+                return false;
+            for (size_t i = 0; i < n; ++i)
+                if ((p[i] | 0x20) != (name[i] | 0x20))
+                    return false;
+            return true;
+        }
+
+        size_t level_id(char const* p, size_t n) const
+        {
+            for (size_t i = 0; i < _levels.size(); ++i)
+                if (equal_nocase(p, n, _levels[i].name))
+                    return id_fixed_count + i;
+            return id_value;
+        }
+
+        size_t key_id(char const* p, size_t n) const
+        {
+            for (size_t i = 0; i < _keys.size(); ++i)
+                if (_keys[i].name.size() == n && std::memcmp(_keys[i].name.data(), p, n) == 0)
+                    return id_fixed_count + _levels.size() + i;
+            return id_value;
+        }
+
+        //! Colorize complete lines in [p, last).
+        void lines(char const* p, char const* last)
+        {
+            _pending = p;
+            while (p != last)
+            {
+                char const* eol = static_cast<char const*>(std::memchr(p, '\n', static_cast<size_t>(last - p)));
+                if (!eol)
+                    eol = last;
+
+                line(p, eol);
+
+                // Every line ends in the default state.
+                switch_to(id_default, eol);
+                p = eol == last ? last : eol + 1;
+            }
+            reserve(static_cast<size_t>(last - _pending));
+            copy(last);
+        }
+
+        void line(char const* p, char const* last)
+        {
+            while (p != last)
+            {
+                // Spaces keep whatever style is active.
+                if (*p == ' ')
+                {
+                    ++p;
+                    if (p != last && *p == ' ')
+                        p = _internal::skip_any(p, last, ' ', ' ', ' ', ' ');
+                    continue;
+                }
+
+                char const* key_end = _internal::find_any(p, last, '=', ' ', '"', '"');
+                if (key_end == last || *key_end != '=')
+                {
+                    // A bare word or a stray quote: leave it as value text.
+                    switch_to(id_value, p);
+                    p = key_end == last ? last : (*key_end == '"' ? quoted_end(key_end, last) : key_end);
+                    continue;
+                }
+
+                switch_to(id_key, p);
+                char const* key = p;
+                size_t key_size = static_cast<size_t>(key_end - p);
+                char const* value = key_end + 1;
+
+                char const* value_end;
+                bool is_quoted = value != last && *value == '"';
+                if (is_quoted)
+                    value_end = quoted_end(value, last);
+                else
+                {
+                    value_end = static_cast<char const*>(std::memchr(value, ' ', static_cast<size_t>(last - value)));
+                    if (!value_end)
+                        value_end = last;
+                }
+
+                size_t id = key_id(key, key_size);
+                if (key_size == _level_key.size() && std::memcmp(key, _level_key.data(), key_size) == 0)
+                {
+                    if (is_quoted && value_end - value >= 2)
+                        id = level_id(value + 1, static_cast<size_t>(value_end - value - 2));
+                    else
+                        id = level_id(value, static_cast<size_t>(value_end - value));
+                }
+                if (id == id_value && is_quoted)
+                    id = id_quoted;
+
+                if (value != value_end)
+                    switch_to(id, value);
+                p = value_end;
+            }
+        }
+
+        //! End of a quoted string starting at \a p, past the closing quote.
+        static char const* quoted_end(char const* p, char const* last)
+        {
+            char const* q = p + 1;
+            while (q < last)
+            {
+                q = _internal::find_any(q, last, '"', '\\');
+                if (q == last)
+                    return last;
+                if (*q == '"')
+                    return q + 1;
+                q += 2;
+            }
+            return last;
+        }
+
+    private:
+        std::ostream&               _stream;
+        bool                        _colors;
+        std::vector<char>           _buffer;
+        size_t                      _used;
+        std::string                 _partial;
+
+        style                       _styles[id_fixed_count];
+        std::vector<named_style>    _levels;
+        std::vector<named_style>    _keys;
+        std::string                 _level_key;
+
+        char const*                 _pending;
+        size_t                      _current;
+        size_t                      _count;
+        std::vector<std::string>    _transitions;
+        bool                        _transitions_ready;
+    };
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_LOGFMT_HPP_
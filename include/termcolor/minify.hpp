@@ -0,0 +1,380 @@
+//!
+//! minify
+//! ~~~~~~
+//!
+//! "Minify" extends termcolor library by adding an ANSI stream minifier,
+//! i.e. an object that rewrites colored output with as few SGR escapes as
+//! give the same picture on the terminal.
+//!
+//! Incoming SGR sequences aren't copied but applied to a `style` with the
+//! same model the rest of the library uses. Only when text follows is the
+//! net change written, as the single merged sequence `append(out, from,
+//! to)` gives, so "\033[00m\033[1m\033[31m" before every token shrinks to
+//! nothing where the state is already right, no-op resets vanish, and
+//! escapes that precede no text are dropped. Other escapes are copied;
+//! those that paint with the background (erasing, inserting, scrolling)
+//! get the pending state first. SGR parameters the model doesn't know
+//! (italic, strikethrough, ...) are copied verbatim, and so is everything
+//! up to the next full reset, so they're never lost.
+//!
+//! The minifier keeps no more than a cut escape sequence between calls,
+//! so it runs in constant memory on streams of any length. Text between
+//! escapes is found with memchr, which libc vectorizes.
+//!
+//! Example.
+//!   sgr_minifier minifier;
+//!   std::string out;
+//!   while (size_t n = read(chunk))
+//!       minifier.feed(chunk, n, out);   // and write `out` away
+//!   minifier.finish(out);
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_MINIFY_HPP_
+#define TERMCOLOR_MINIFY_HPP_
+
+#include <termcolor/core.hpp>
+#include <termcolor/scan.hpp>
+
+#include <cstring>
+#include <streambuf>
+#include <string>
+
+namespace termcolor
+{
+    namespace _internal
+    {
+        //! What the parameters of an SGR sequence do beyond the `style`
+        //! model: whether they reset everything at some point, and whether
+        //! a parameter the model ignores comes after the last reset.
+        struct sgr_effect
+        {
+            bool resets;
+            bool unknown;
+        };
+
+        inline sgr_effect sgr_parameters_effect(char const* params, size_t length)
+        {
+            unsigned values[32];
+            size_t count = 0;
+            values[0] = 0;
+            for (size_t i = 0; i < length; ++i)
+            {
+                char c = params[i];
+                if (c == ';' || c == ':')
+                {
+                    if (++count == 32)
+                        break;
+                    values[count] = 0;
+                }
+                else if (c >= '0' && c <= '9' && values[count] < 1000)
+                    values[count] = values[count] * 10 + static_cast<unsigned>(c - '0');
+            }
+            if (count < 32)
+                ++count;
+
+            sgr_effect effect = { false, false };
+            for (size_t i = 0; i < count; ++i)
+            {
+                unsigned v = values[i];
+                if (v == 0)
+                {
+                    effect.resets  = true;
+                    effect.unknown = false;
+                }
+                else if (v == 38 || v == 48)
+                {
+                    if (i + 2 < count && values[i + 1] == 5)
+                        i += 2;
+                    else if (i + 4 < count && values[i + 1] == 2)
+                        i += 4;
+                    else
+                    {
+                        effect.unknown = true;
+                        break;
+                    }
+                }
+                else if (!(v <= 8 && v != 3) && !(v >= 22 && v <= 28 && v != 23 && v != 26) &&
+                         !(v >= 30 && v <= 37) && v != 39 && !(v >= 40 && v <= 47) && v != 49 &&
+                         !(v >= 90 && v <= 97) && !(v >= 100 && v <= 107))
+                    effect.unknown = true;
+            }
+            return effect;
+        }
+    }
+
+    class sgr_minifier
+    {
+        //! Longer cut sequences are given up on and copied as they are.
+        static size_t const max_partial = 4096;
+
+        struct transition
+        {
+            transition() : used(false) {}
+
+            style       from, to;
+            std::string sgr;
+            bool        used;
+        };
+
+    public:
+        sgr_minifier()
+            : _verbatim(false)
+            , _in(0)
+            , _out(0)
+        {
+        }
+
+        //! Minify \a size bytes and append the result to \a out. Escape
+        //! sequences may be split between calls.
+        void feed(char const* p, size_t size, std::string& out)
+        {
+            size_t before = out.size();
+            _in += size;
+            char const* last = p + size;
+
+            if (!_partial.empty())
+            {
+                size_t had = _partial.size();
+                size_t take = size < max_partial - had ? size : max_partial - had;
+                _partial.append(p, take);
+
+                char const* first = _partial.data();
+                char const* end = first + _partial.size();
+                size_t length = _internal::escape_length(first, end);
+                if (_internal::escape_complete(first, length, end))
+                {
+                    escape(first, length, out);
+                    p += length - had;
+                    _partial.clear();
+                }
+                else if (_partial.size() == max_partial)
+                {
+                    sync(out);
+                    out += _partial;
+                    p += take;
+                    _partial.clear();
+                }
+                else
+                {
+                    _out += out.size() - before;
+                    return;
+                }
+            }
+
+            parse(p, last, out);
+            _out += out.size() - before;
+        }
+
+        void feed(std::string const& in, std::string& out)
+        {
+            feed(in.data(), in.size(), out);
+        }
+
+        //! End of the stream: append what's left of a cut sequence and the
+        //! state the input ended in, if it differs from what was written,
+        //! so minified streams can be concatenated like the originals.
+        void finish(std::string& out)
+        {
+            size_t before = out.size();
+            if (!_partial.empty())
+            {
+                sync(out);
+                out += _partial;
+                _partial.clear();
+            }
+            sync(out);
+            _out += out.size() - before;
+        }
+
+        //! Bytes fed and written so far.
+        uint64_t bytes_in()  const { return _in; }
+        uint64_t bytes_out() const { return _out; }
+
+    private:
+        void parse(char const* p, char const* last, std::string& out)
+        {
+            while (p != last)
+            {
+                char const* esc = static_cast<char const*>(std::memchr(p, '\033', static_cast<size_t>(last - p)));
+                if (esc != p)
+                {
+                    sync(out);
+                    out.append(p, esc ? esc : last);
+                    if (!esc)
+                        return;
+                }
+
+                size_t length = _internal::escape_length(esc, last);
+                if (!_internal::escape_complete(esc, length, last))
+                {
+                    if (length < max_partial)
+                        _partial.assign(esc, last);
+                    else
+                    {
+                        sync(out);
+                        out.append(esc, last);
+                    }
+                    return;
+                }
+                escape(esc, length, out);
+                p = esc + length;
+            }
+        }
+
+        void escape(char const* p, size_t length, std::string& out)
+        {
+            if (!_internal::is_sgr(p, length))
+            {
+                if (paints(p, length))
+                    sync(out);
+                out.append(p, length);
+                return;
+            }
+
+            _internal::sgr_effect effect = _internal::sgr_parameters_effect(p + 2, length - 3);
+            if (_verbatim || effect.unknown)
+            {
+                // Apply the pending state, then the sequence itself, which
+                // the model can't fully follow any more.
+                sync(out);
+                out.append(p, length);
+                _wanted.apply(p + 2, length - 3);
+                _shown = _wanted;
+                _verbatim = effect.unknown || (_verbatim && !effect.resets);
+                return;
+            }
+            _wanted.apply(p + 2, length - 3);
+        }
+
+        //! CSI sequences that fill cells with the current background.
+        static bool paints(char const* p, size_t length)
+        {
+            if (length < 3 || p[1] != '[')
+                return false;
+            char kind = p[length - 1];
+            return kind == 'J' || kind == 'K' || kind == 'X' || kind == '@' || kind == 'P' ||
+                   kind == 'L' || kind == 'M' || kind == 'S' || kind == 'T';
+        }
+
+        //! Write the transition to the wanted state. Logs repeat the same
+        //! few transitions over and over, so they're kept in a small
+        //! direct-mapped cache rather than encoded every time.
+        void sync(std::string& out)
+        {
+            if (_wanted == _shown)
+                return;
+
+            uint64_t from, to;
+            std::memcpy(&from, &_shown, sizeof(from));
+            std::memcpy(&to, &_wanted, sizeof(to));
+            transition& t = _transitions[((from * 0x9e3779b97f4a7c15ull) ^ (to * 0xc2b2ae3d27d4eb4full)) >> 60];
+            if (!t.used || !(t.from == _shown) || !(t.to == _wanted))
+            {
+                t.from = _shown;
+                t.to   = _wanted;
+                t.used = true;
+                t.sgr.clear();
+                append(t.sgr, _shown, _wanted);
+            }
+            out += t.sgr;
+            _shown = _wanted;
+        }
+
+    private:
+        style       _wanted;        // the state the input asked for
+        style       _shown;         // the state written so far
+        bool        _verbatim;      // unknown attributes may be active
+        std::string _partial;
+        transition  _transitions[16];
+        uint64_t    _in;
+        uint64_t    _out;
+    };
+
+    //! Minify a whole string.
+    inline
+    std::string minify(char const* p, size_t size)
+    {
+        sgr_minifier minifier;
+        std::string out;
+        out.reserve(size);
+        minifier.feed(p, size, out);
+        minifier.finish(out);
+        return out;
+    }
+
+    inline
+    std::string minify(std::string const& ansi)
+    {
+        return minify(ansi.data(), ansi.size());
+    }
+
+    //! A stream buffer minifying everything written through it into
+    //! another one, e.g. a file's, in blocks of up to 64 KiB. The end
+    //! state is written on destruction.
+    //!
+    //! Example.
+    //!   std::ofstream log("session.log");
+    //!   minify_streambuf minified(log.rdbuf());
+    //!   std::ostream out(&minified);
+    //!   out << colorize << style().bold() << "minified" << reset << "\n";
+    class minify_streambuf : public std::streambuf
+    {
+    public:
+        explicit minify_streambuf(std::streambuf* target)
+            : _target(target)
+        {
+        }
+
+        ~minify_streambuf()
+        {
+            sync();
+            _minifier.finish(_block);
+            write();
+        }
+
+        sgr_minifier const& minifier() const { return _minifier; }
+
+    protected:
+        std::streamsize xsputn(char const* p, std::streamsize n)
+        {
+            _minifier.feed(p, static_cast<size_t>(n), _block);
+            if (_block.size() >= (1 << 16))
+                write();
+            return n;
+        }
+
+        int_type overflow(int_type c)
+        {
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+            {
+                char ch = traits_type::to_char_type(c);
+                xsputn(&ch, 1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        int sync()
+        {
+            write();
+            return _target->pubsync();
+        }
+
+    private:
+        void write()
+        {
+            if (!_block.empty())
+                _target->sputn(_block.data(), static_cast<std::streamsize>(_block.size()));
+            _block.clear();
+        }
+
+    private:
+        std::streambuf* _target;
+        sgr_minifier    _minifier;
+        std::string     _block;
+    };
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_MINIFY_HPP_
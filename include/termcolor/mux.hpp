@@ -0,0 +1,442 @@
+//!
+//! mux
+//! ~~~
+//!
+//! "Mux" extends termcolor library by adding an output multiplexer, i.e.
+//! an object that runs many child processes at once and merges their
+//! colored output into one stream, line by line, each line prefixed with
+//! a colored tag of its child.
+//!
+//! Every child writes to a pipe or a pseudo-terminal of its own (the
+//! latter makes it believe it's on a terminal, so it colors its output),
+//! and all of them are read by one thread with epoll. Output is cut into
+//! whole lines, so lines of different children never mix. Each child's
+//! SGR state is tracked across lines: a line starts with its tag, then
+//! the style the child had active there, and ends in the default state,
+//! so a color left on by one child never bleeds into the next line or
+//! another child's tag. Lines are gathered into one buffer and written
+//! once per round of ready children (or every 64 KiB), rather than one
+//! write per line.
+//!
+//! Example.
+//!   output_mux mux;
+//!   for (size_t i = 0; i < jobs.size(); ++i)
+//!       mux.spawn(jobs[i].argv, jobs[i].name + " | ", style().cyan(), output_mux::pty);
+//!   mux.run();
+//!   if (mux.exit_status(0) != 0)
+//!       ...
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_MUX_HPP_
+#define TERMCOLOR_MUX_HPP_
+
+#include <termcolor/core.hpp>
+#include <termcolor/scan.hpp>
+
+#if defined(__linux__)
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace termcolor
+{
+    class output_mux
+    {
+        struct child
+        {
+            int         fd;
+            pid_t       pid;
+            std::string tag;
+            style       tag_style;
+            style       s;              // the child's state after its last full line
+            std::string pending;        // the start of a line not yet complete
+            int         status;
+        };
+
+        //! Longer lines are cut, so a child that never ends its lines
+        //! can't hold unbounded memory.
+        static size_t const max_line = 1 << 16;
+
+        //! Lines are written once this much is gathered, at the latest.
+        static size_t const batch = 1 << 16;
+
+    public:
+        enum channel
+        {   pipe
+        ,   pty
+        };
+
+        //! Colors are on if \a fd is a terminal, as for `std::cout`.
+        explicit output_mux(int fd = STDOUT_FILENO)
+            : _fd(fd)
+            , _colors(::isatty(fd) != 0)
+            , _written(0)
+            , _writes(0)
+            , _lines(0)
+        {
+        }
+
+        ~output_mux()
+        {
+            for (size_t i = 0; i < _children.size(); ++i)
+                if (_children[i].fd >= 0)
+                    ::close(_children[i].fd);
+        }
+
+        //! Force colors on or off, like `colorize` / `nocolorize`. Without
+        //! colors the children's escapes are left out too.
+        output_mux& colors(bool on) { _colors = on; return *this; }
+
+        //! Start `argv[0]` (looked up in PATH) with its stdout and stderr
+        //! on a new pipe or pty; its lines will be prefixed with \a tag in
+        //! \a tag_style. Returns the child's index, or -1 if it couldn't
+        //! be started.
+        int spawn(std::vector<std::string> const& argv, std::string const& tag,
+                  style const& tag_style = style(), channel via = pipe)
+        {
+            if (argv.empty())
+                return -1;
+
+            // Everything the child needs is prepared before the fork, as
+            // only async-signal-safe calls may follow it.
+            std::vector<char*> args;
+            for (size_t i = 0; i < argv.size(); ++i)
+                args.push_back(const_cast<char*>(argv[i].c_str()));
+            args.push_back(0);
+            std::string failed = "termcolor: cannot run " + argv[0] + "\n";
+
+            int ours, theirs;
+            if (!(via == pty ? open_pty(ours, theirs) : open_pipe(ours, theirs)))
+                return -1;
+
+            pid_t pid = ::fork();
+            if (pid == 0)
+            {
+                if (via == pty)
+                {
+                    ::setsid();
+                    ::ioctl(theirs, TIOCSCTTY, 0);
+                }
+                ::dup2(theirs, STDOUT_FILENO);
+                ::dup2(theirs, STDERR_FILENO);
+                ::execvp(args[0], &args[0]);
+                ssize_t ignored = ::write(STDERR_FILENO, failed.data(), failed.size());
+                (void)ignored;
+                ::_exit(127);
+            }
+            ::close(theirs);
+            if (pid < 0)
+            {
+                ::close(ours);
+                return -1;
+            }
+            return add(ours, pid, tag, tag_style);
+        }
+
+        //! Multiplex an output that is already open, e.g. the read end of
+        //! a pipe a thread writes to. The mux closes \a fd when done.
+        int attach(int fd, std::string const& tag, style const& tag_style = style())
+        {
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+            return add(fd, -1, tag, tag_style);
+        }
+
+        //! Merge the children's output until all of them have closed it,
+        //! then wait for the spawned ones to exit. Returns false if
+        //! writing failed; the children are still waited for.
+        bool run()
+        {
+            _written = 0;
+            _writes = 0;
+            _lines = 0;
+
+            int poller = ::epoll_create1(EPOLL_CLOEXEC);
+            if (poller < 0)
+                return false;
+
+            size_t open = 0;
+            for (size_t i = 0; i < _children.size(); ++i)
+            {
+                if (_children[i].fd < 0)
+                    continue;
+                struct epoll_event e;
+                e.events = EPOLLIN;
+                e.data.u64 = i;
+                if (::epoll_ctl(poller, EPOLL_CTL_ADD, _children[i].fd, &e) == 0)
+                    ++open;
+                else
+                    finish(_children[i]);
+            }
+
+            bool ok = true;
+            std::vector<struct epoll_event> events(open < 256 ? open + 1 : 256);
+            std::vector<char> buffer(batch);
+            while (open)
+            {
+                int ready = ::epoll_wait(poller, &events[0], static_cast<int>(events.size()), -1);
+                if (ready < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    ok = false;
+                    break;
+                }
+
+                // One read per ready child and round keeps chatty children
+                // from starving the others.
+                for (int r = 0; r < ready; ++r)
+                {
+                    child& c = _children[static_cast<size_t>(events[r].data.u64)];
+                    ssize_t n = ::read(c.fd, &buffer[0], buffer.size());
+                    if (n < 0 && (errno == EINTR || errno == EAGAIN))
+                        continue;
+                    if (n > 0)
+                        take(c, &buffer[0], static_cast<size_t>(n));
+                    else
+                    {
+                        // End of output; a pty reports it as EIO once the
+                        // child's side is closed.
+                        finish(c);
+                        --open;
+                    }
+                    if (_out.size() >= batch)
+                        ok = flush(ok);
+                }
+                ok = flush(ok);
+            }
+            ::close(poller);
+
+            for (size_t i = 0; i < _children.size(); ++i)
+                finish(_children[i]);
+            ok = flush(ok);
+
+            for (size_t i = 0; i < _children.size(); ++i)
+            {
+                child& c = _children[i];
+                while (c.pid > 0 && ::waitpid(c.pid, &c.status, 0) < 0 && errno == EINTR)
+                    ;
+                c.pid = -1;
+            }
+            return ok;
+        }
+
+        size_t children() const { return _children.size(); }
+
+        //! Status of child \a i as from waitpid, after `run()`; -1 if it
+        //! wasn't spawned.
+        int exit_status(size_t i) const { return _children[i].status; }
+
+        //! Bytes written, write calls made and lines merged by the last
+        //! `run()`.
+        uint64_t written() const { return _written; }
+        uint64_t writes()  const { return _writes; }
+        uint64_t lines()   const { return _lines; }
+
+    private:
+        int add(int fd, pid_t pid, std::string const& tag, style const& tag_style)
+        {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            child c;
+            c.fd        = fd;
+            c.pid       = pid;
+            c.tag       = tag;
+            c.tag_style = tag_style;
+            c.status    = -1;
+            _children.push_back(c);
+            return static_cast<int>(_children.size() - 1);
+        }
+
+        static bool open_pipe(int& ours, int& theirs)
+        {
+            int ends[2];
+            if (::pipe2(ends, O_CLOEXEC) != 0)
+                return false;
+            ours = ends[0];
+            theirs = ends[1];
+            return true;
+        }
+
+        //! A pty whose child side passes line breaks through as they are
+        //! (no "\r\n") and has the size of our terminal, if we're on one.
+        bool open_pty(int& ours, int& theirs) const
+        {
+            ours = ::posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+            if (ours < 0)
+                return false;
+            char const* name;
+            if (::grantpt(ours) != 0 || ::unlockpt(ours) != 0 || !(name = ::ptsname(ours)) ||
+                (theirs = ::open(name, O_RDWR | O_NOCTTY | O_CLOEXEC)) < 0)
+            {
+                ::close(ours);
+                return false;
+            }
+
+            struct termios mode;
+            if (::tcgetattr(theirs, &mode) == 0)
+            {
+                mode.c_oflag &= ~static_cast<tcflag_t>(OPOST);
+                mode.c_lflag &= ~static_cast<tcflag_t>(ECHO);
+                ::tcsetattr(theirs, TCSANOW, &mode);
+            }
+            struct winsize size;
+            if (::ioctl(_fd, TIOCGWINSZ, &size) == 0)
+                ::ioctl(theirs, TIOCSWINSZ, &size);
+            return true;
+        }
+
+        //! Append \a n bytes of \a c's output: complete lines go out, the
+        //! rest waits for more.
+        void take(child& c, char const* p, size_t n)
+        {
+            char const* last = p + n;
+            if (!c.pending.empty())
+            {
+                char const* eol = static_cast<char const*>(std::memchr(p, '\n', n));
+                if (!eol && c.pending.size() + n < max_line)
+                {
+                    c.pending.append(p, n);
+                    return;
+                }
+                char const* end = eol ? eol + 1 : last;
+                c.pending.append(p, end);
+                line(c, c.pending.data(), c.pending.data() + c.pending.size());
+                c.pending.clear();
+                p = end;
+            }
+
+            while (p != last)
+            {
+                char const* eol = static_cast<char const*>(std::memchr(p, '\n', static_cast<size_t>(last - p)));
+                if (!eol)
+                {
+                    if (static_cast<size_t>(last - p) < max_line)
+                        c.pending.assign(p, last);
+                    else
+                        line(c, p, last);
+                    return;
+                }
+                line(c, p, eol + 1);
+                p = eol + 1;
+            }
+        }
+
+        //! Write out what's left of \a c's output and stop reading it.
+        void finish(child& c)
+        {
+            if (c.fd < 0)
+                return;
+            if (!c.pending.empty())
+                line(c, c.pending.data(), c.pending.data() + c.pending.size());
+            c.pending.clear();
+            ::close(c.fd);
+            c.fd = -1;
+        }
+
+        //! One line, [p, last), with or without its line break (a cut or
+        //! unterminated line gets one).
+        void line(child& c, char const* p, char const* last)
+        {
+            ++_lines;
+            if (last != p && last[-1] == '\n')
+                --last;
+            if (last != p && last[-1] == '\r')
+                --last;
+
+            if (!_colors)
+            {
+                _out += c.tag;
+                while (p != last)
+                {
+                    char const* esc = static_cast<char const*>(std::memchr(p, '\033', static_cast<size_t>(last - p)));
+                    _out.append(p, esc ? esc : last);
+                    if (!esc)
+                        break;
+                    p = esc + _internal::escape_length(esc, last);
+                }
+                _out += '\n';
+                return;
+            }
+
+            if (c.tag.empty())
+                append(_out, style(), c.s);
+            else
+            {
+                append(_out, style(), c.tag_style);
+                _out += c.tag;
+                append(_out, c.tag_style, c.s);
+            }
+
+            char const* begin = p;
+            while (p != last)
+            {
+                p = static_cast<char const*>(std::memchr(p, '\033', static_cast<size_t>(last - p)));
+                if (!p)
+                    break;
+                size_t length = _internal::escape_length(p, last);
+                if (_internal::is_sgr(p, length))
+                    c.s.apply(p + 2, length - 3);
+                p += length;
+            }
+            _out.append(begin, last);
+            append(_out, c.s, style());
+            _out += '\n';
+        }
+
+        //! Write the gathered lines, or drop them if writing failed before.
+        bool flush(bool ok)
+        {
+            if (!ok)
+            {
+                _out.clear();
+                return false;
+            }
+
+            char const* p = _out.data();
+            size_t left = _out.size();
+            while (left)
+            {
+                ssize_t n = ::write(_fd, p, left);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    _out.clear();
+                    return false;
+                }
+                ++_writes;
+                _written += static_cast<uint64_t>(n);
+                p += n;
+                left -= static_cast<size_t>(n);
+            }
+            _out.clear();
+            return true;
+        }
+
+    private:
+        int                         _fd;
+        bool                        _colors;
+        uint64_t                    _written;
+        uint64_t                    _writes;
+        uint64_t                    _lines;
+        std::vector<child>          _children;
+        std::string                 _out;
+    };
+
+} // namespace termcolor
+
+#endif // __linux__
+
+#endif // TERMCOLOR_MUX_HPP_
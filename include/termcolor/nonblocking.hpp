@@ -0,0 +1,496 @@
+//!
+//! nonblocking
+//! ~~~~~~~~~~~
+//!
+//! "Nonblocking" extends termcolor library by adding a non-blocking
+//! terminal output, i.e. an object that owns a file descriptor in
+//! O_NONBLOCK mode and queues colored output for a background thread, so
+//! a stalled terminal (say, a frozen ssh link) never blocks the writer.
+//!
+//! Pending output is kept in a bounded buffer. Frames are writes that
+//! replace earlier ones: a queued frame that hasn't been started yet is
+//! dropped as soon as a newer frame with the same key arrives, so while
+//! the terminal is slow only the latest status reaches it. Plain writes
+//! are never coalesced; when the buffer is full they are dropped whole.
+//! The background thread drains the queue with writev and sleeps in
+//! epoll until the descriptor is writable again. It takes a batch of
+//! entries out of the queue under the lock and writes them after
+//! releasing it, so producers never wait on the terminal. Byte counts of
+//! written, dropped and coalesced output are available with
+//! `statistics()`.
+//!
+//! O_NONBLOCK is a flag of the open file description, not of the
+//! descriptor, so while the object lives it also applies to every
+//! process sharing it (e.g. the shell that started the program, if the
+//! descriptor is an inherited stdout). The old flags are restored on
+//! destruction. If epoll or eventfd can't be set up, the descriptor is
+//! left as it is and writes go straight to it, blocking.
+//!
+//! Every write and frame should be self-contained (e.g. a frame redraws
+//! the whole status line and resets the style at the end) since any of
+//! them may be dropped. Linux only.
+//!
+//! Example.
+//!   nonblocking_output out(STDOUT_FILENO);
+//!   out.frame("status", "\r\033[K\033[32m42%\033[0m");
+//!   out.write("done\n");
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_NONBLOCKING_HPP_
+#define TERMCOLOR_NONBLOCKING_HPP_
+
+#include <termcolor/core.hpp>
+
+#if defined(__linux__)
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace termcolor
+{
+    class nonblocking_output
+    {
+        //! A queued write. Frames have a non-empty key; `offset` is the
+        //! part of the data already written. A frame being written when a
+        //! newer one arrives is `superseded`: it's dropped if the write
+        //! doesn't reach it.
+        struct entry
+        {
+            std::string key;
+            std::string data;
+            size_t      offset;
+            bool        superseded;
+        };
+
+    public:
+        //! Byte counts since construction.
+        struct stats
+        {
+            uint64_t written;       // reached the descriptor
+            uint64_t dropped;       // didn't fit into the buffer or failed
+            uint64_t coalesced;     // frames replaced by newer ones
+            uint64_t pending;       // queued right now
+            uint64_t stalls;        // times the descriptor wasn't writable
+        };
+
+        //! \a capacity bounds the pending output in bytes. The descriptor
+        //! stays owned by the caller; its flags are restored on
+        //! destruction, but other processes sharing it see O_NONBLOCK
+        //! until then.
+        explicit nonblocking_output(int fd, size_t capacity = 1 << 20)
+            : _fd(fd)
+            , _flags(-1)
+            , _capacity(capacity)
+            , _pending(0)
+            , _linger(std::chrono::seconds(1))
+            , _stopping(false)
+            , _failed(false)
+            , _epoll(::epoll_create1(EPOLL_CLOEXEC))
+            , _wakeup(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+            , _pollable(false)
+        {
+            _stats.written = _stats.dropped = _stats.coalesced = _stats.pending = _stats.stalls = 0;
+
+            // Without a poller and a wakeup there is no writer thread:
+            // writes go to the descriptor as they come, blocking.
+            epoll_event event;
+            event.events  = EPOLLIN;
+            event.data.fd = _wakeup;
+            if (_epoll < 0 || _wakeup < 0 || ::epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeup, &event) != 0)
+                return;
+
+            _flags = ::fcntl(fd, F_GETFL);
+            if (_flags != -1)
+                ::fcntl(fd, F_SETFL, _flags | O_NONBLOCK);
+
+            // Regular files can't be polled, but they never block either.
+            event.events  = EPOLLOUT | EPOLLET;
+            event.data.fd = fd;
+            _pollable = ::epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) == 0;
+
+            _thread = std::thread(&nonblocking_output::run, this);
+        }
+
+        //! Waits up to the linger time for the queue to drain, then drops
+        //! whatever is left.
+        ~nonblocking_output()
+        {
+            if (_thread.joinable())
+            {
+                flush(_linger);
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stopping = true;
+                }
+                notify();
+                _thread.join();
+            }
+
+            if (_flags != -1)
+                ::fcntl(_fd, F_SETFL, _flags);
+            if (_wakeup >= 0)
+                ::close(_wakeup);
+            if (_epoll >= 0)
+                ::close(_epoll);
+        }
+
+        //! How long the destructor waits for pending output.
+        nonblocking_output& linger(std::chrono::milliseconds timeout)
+        {
+            _linger = timeout;
+            return *this;
+        }
+
+        //! Queue \a size bytes. Returns false if they were dropped because
+        //! the buffer is full.
+        bool write(char const* data, size_t size)
+        {
+            return push(std::string(), data, size);
+        }
+
+        bool write(std::string const& data)
+        {
+            return push(std::string(), data.data(), data.size());
+        }
+
+        //! Queue a frame that supersedes any not yet started frame with the
+        //! same \a key. Returns false if it was dropped.
+        bool frame(std::string const& key, std::string const& data)
+        {
+            return push(key, data.data(), data.size());
+        }
+
+        //! Wait until everything queued has been written. Returns false on
+        //! timeout or if the descriptor failed.
+        bool flush(std::chrono::milliseconds timeout)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _drained.wait_for(lock, timeout, [this] { return _queue.empty() && _batch.empty(); });
+            return _queue.empty() && _batch.empty() && !_failed;
+        }
+
+        stats statistics() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            stats s = _stats;
+            s.pending = _pending;
+            return s;
+        }
+
+    private:
+        bool push(std::string const& key, char const* data, size_t size)
+        {
+            if (!_thread.joinable())
+                return write_through(data, size);
+
+            bool was_empty;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                if (!key.empty())
+                    coalesce(key);
+
+                if (_failed || _pending + size > _capacity)
+                {
+                    _stats.dropped += size;
+                    return false;
+                }
+
+                entry e;
+                e.key.assign(key);
+                e.data.assign(data, size);
+                e.offset = 0;
+                e.superseded = false;
+
+                was_empty = _queue.empty();
+                _queue.push_back(e);
+                _pending += size;
+            }
+
+            // A non-empty queue means the drainer is busy or waits for the
+            // descriptor, and will see the new entry anyway.
+            if (was_empty)
+                notify();
+            return true;
+        }
+
+        //! Write \a size bytes right away, for when there is no writer
+        //! thread.
+        bool write_through(char const* data, size_t size)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (size_t done = 0; !_failed && done < size; )
+            {
+                ssize_t n = ::write(_fd, data + done, size - done);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0)
+                {
+                    _failed = true;
+                    _stats.dropped += size - done;
+                    return false;
+                }
+                done += static_cast<size_t>(n);
+                _stats.written += static_cast<size_t>(n);
+            }
+            return !_failed;
+        }
+
+        //! Drop queued frames with \a key that haven't been started.
+        void coalesce(std::string const& key)
+        {
+            // The batch being written can't be taken back; its frames are
+            // dropped when it returns, unless the write reached them.
+            for (size_t i = 0; i < _batch.size(); ++i)
+            {
+                entry& e = _batch[i];
+                if (e.offset == 0 && !e.superseded && e.key == key)
+                {
+                    e.superseded = true;
+                    _stats.coalesced += e.data.size();
+                    _pending -= e.data.size();
+                }
+            }
+
+            for (std::deque<entry>::iterator it = _queue.begin(); it != _queue.end(); )
+            {
+                if (it->offset == 0 && it->key == key)
+                {
+                    _stats.coalesced += it->data.size();
+                    _pending -= it->data.size();
+                    it = _queue.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
+
+        void notify()
+        {
+            uint64_t one = 1;
+            ssize_t n = ::write(_wakeup, &one, sizeof(one));
+            (void)n;
+        }
+
+        //! Write as much of the queue as the descriptor takes. Returns
+        //! false if it would block. Entries are moved out of the queue into
+        //! the batch under the mutex and written after releasing it; what
+        //! wasn't written goes back to the front of the queue.
+        bool drain()
+        {
+            for (;;)
+            {
+                iovec chunks[64];
+                int count = 0;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    for (; !_queue.empty() && count < 64; ++count)
+                    {
+                        _batch.push_back(std::move(_queue.front()));
+                        _queue.pop_front();
+                    }
+                    for (int i = 0; i < count; ++i)
+                    {
+                        entry const& e = _batch[static_cast<size_t>(i)];
+                        chunks[i].iov_base = const_cast<char*>(e.data.data() + e.offset);
+                        chunks[i].iov_len  = e.data.size() - e.offset;
+                    }
+                }
+                if (!count)
+                    return true;
+
+                ssize_t n = ::writev(_fd, chunks, count);
+                int error = n < 0 ? errno : 0;
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (n < 0 && error != EINTR && error != EAGAIN && error != EWOULDBLOCK)
+                {
+                    // The terminal is gone; nothing will ever be written.
+                    _failed = true;
+                    _stats.dropped += _pending;
+                    _pending = 0;
+                    _queue.clear();
+                    _batch.clear();
+                    return true;
+                }
+
+                size_t done = n > 0 ? static_cast<size_t>(n) : 0;
+                _stats.written += done;
+                size_t first = 0;
+                for (; first < _batch.size() && done; ++first)
+                {
+                    entry& e = _batch[first];
+                    if (e.superseded)
+                    {
+                        // Started after all, so not coalesced.
+                        e.superseded = false;
+                        _stats.coalesced -= e.data.size();
+                        _pending += e.data.size();
+                    }
+                    size_t left = e.data.size() - e.offset;
+                    size_t taken = done < left ? done : left;
+                    e.offset += taken;
+                    _pending -= taken;
+                    done -= taken;
+                    if (taken < left)
+                        break;
+                }
+
+                for (size_t i = _batch.size(); i-- > first; )
+                    if (!_batch[i].superseded)
+                        _queue.push_front(std::move(_batch[i]));
+                _batch.clear();
+
+                if (error == EAGAIN || error == EWOULDBLOCK)
+                {
+                    ++_stats.stalls;
+                    return false;
+                }
+            }
+        }
+
+        void run()
+        {
+            for (;;)
+            {
+                bool blocked = !drain();
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (_queue.empty())
+                        _drained.notify_all();
+                    if (_stopping)
+                    {
+                        _stats.dropped += _pending;
+                        _pending = 0;
+                        _queue.clear();
+                        _drained.notify_all();
+                        return;
+                    }
+                }
+
+                if (blocked && !_pollable)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+
+                // Wakes up on new entries or once the descriptor is
+                // writable again.
+                epoll_event events[2];
+                int n = ::epoll_wait(_epoll, events, 2, -1);
+                for (int i = 0; i < n; ++i)
+                    if (events[i].data.fd == _wakeup)
+                    {
+                        uint64_t count;
+                        ssize_t r = ::read(_wakeup, &count, sizeof(count));
+                        (void)r;
+                    }
+            }
+        }
+
+    private:
+        int                         _fd;
+        int                         _flags;
+        size_t                      _capacity;
+
+        mutable std::mutex          _mutex;
+        std::condition_variable     _drained;
+        std::deque<entry>           _queue;
+        std::vector<entry>          _batch;     // being written, off the queue
+        size_t                      _pending;
+        stats                       _stats;
+        std::chrono::milliseconds   _linger;
+        bool                        _stopping;
+        bool                        _failed;
+
+        int                         _epoll;
+        int                         _wakeup;
+        bool                        _pollable;
+        std::thread                 _thread;
+    };
+
+    //! A stream buffer over `nonblocking_output`, so that the usual
+    //! manipulators can be used. Output is collected until the stream is
+    //! flushed and is queued as a single write, or as a frame if a key is
+    //! given.
+    //!
+    //! Example.
+    //!   nonblocking_streambuf buffer(out, "status");
+    //!   std::ostream status(&buffer);
+    //!   status << colorize << "\r" << green << percent << "%" << reset << std::flush;
+    class nonblocking_streambuf : public std::streambuf
+    {
+    public:
+        explicit nonblocking_streambuf(nonblocking_output& output, std::string const& key = std::string())
+            : _output(output)
+            , _key(key)
+            , _buffer(256)
+        {
+            setp(&_buffer[0], &_buffer[0] + _buffer.size());
+        }
+
+        ~nonblocking_streambuf()
+        {
+            sync();
+        }
+
+    protected:
+        //! Grow rather than split: a partial write would be dropped or
+        //! coalesced on its own.
+        int_type overflow(int_type c)
+        {
+            size_t used = static_cast<size_t>(pptr() - pbase());
+            _buffer.resize(_buffer.size() * 2);
+            setp(&_buffer[0], &_buffer[0] + _buffer.size());
+            pbump(static_cast<int>(used));
+
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+            {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        int sync()
+        {
+            size_t used = static_cast<size_t>(pptr() - pbase());
+            if (used)
+            {
+                if (_key.empty())
+                    _output.write(pbase(), used);
+                else
+                    _output.frame(_key, std::string(pbase(), used));
+                setp(&_buffer[0], &_buffer[0] + _buffer.size());
+            }
+            return 0;
+        }
+
+    private:
+        nonblocking_output& _output;
+        std::string         _key;
+        std::vector<char>   _buffer;
+    };
+
+} // namespace termcolor
+
+#endif // __linux__
+
+#endif // TERMCOLOR_NONBLOCKING_HPP_
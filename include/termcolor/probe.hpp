@@ -0,0 +1,297 @@
+//!
+//! probe
+//! ~~~~~
+//!
+//! "Probe" extends termcolor library by adding a terminal probe, i.e. a
+//! function that asks the terminal itself which colors it shows, instead
+//! of trusting TERM and COLORTERM (which multiplexers and ssh often get
+//! wrong), and a manipulator that limits a stream's colors accordingly.
+//!
+//! The terminal is switched to raw mode and sent a batch of queries:
+//! DECRQSS for the SGR state right after setting a 24-bit background (a
+//! terminal with true color reports the color back; the caller's state is
+//! saved before and restored after with DECSC / DECRC), OSC 4 for palette
+//! entry 255 (answered by terminals with 256 colors), OSC 10 and OSC 11
+//! for the default foreground and background, and finally DA1, which every
+//! terminal answers. Terminals answer in order, so once the DA1 reply
+//! arrives the queries that weren't answered are known to be unsupported,
+//! and there is no need to wait for the timeout. Replies are read from the
+//! controlling terminal ("/dev/tty", or stdin if it's a terminal), since
+//! that's where a terminal sends them, not from the output descriptor. A
+//! terminal that stays silent (or isn't a terminal) leaves the depth
+//! unknown. The result is cached per terminal for the lifetime of the
+//! process, keyed on the device and inode behind the descriptor (and the
+//! node's change time, which tells a pty number reused later on apart).
+//!
+//! Example.
+//!   std::cout << probe << color(255, 128, 0) << "orange" << reset;
+//!
+//!   terminal_colors colors = probe_terminal(STDOUT_FILENO);
+//!   if (colors.has_background && colors.background[0] < 128)
+//!       ...   // a dark theme
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_PROBE_HPP_
+#define TERMCOLOR_PROBE_HPP_
+
+#include <termcolor/termcolor.hpp>
+
+#if defined(__unix__) || defined(__unix) || defined(__APPLE__)
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace termcolor
+{
+    //! What a terminal told about its colors.
+    struct terminal_colors
+    {
+        bool        answered;           // it replied to the queries at all
+        color_depth depth;              // colors_unknown if it didn't
+        bool        has_foreground;     // default colors, from OSC 10 / 11
+        bool        has_background;
+        uint8_t     foreground[3];
+        uint8_t     background[3];
+    };
+
+    namespace _internal
+    {
+        //! 24-bit background that is set and queried back, between saving
+        //! and restoring the caller's state.
+        static char const probe_queries[] =
+            "\0337\033[48;2;1;2;3m\033P$qm\033\\\0338"
+            "\033]4;255;?\033\\"
+            "\033]10;?\033\\"
+            "\033]11;?\033\\"
+            "\033[c";
+
+        //! The payload of the first string sequence (OSC or DCS) in
+        //! \a replies starting with \a prefix, up to its BEL or ST.
+        inline bool find_reply(std::string const& replies, char const* prefix, std::string& payload)
+        {
+            size_t at = replies.find(prefix);
+            if (at == std::string::npos)
+                return false;
+            at += std::strlen(prefix);
+            size_t end = replies.find_first_of("\007\033", at);
+            if (end == std::string::npos)
+                return false;
+            payload.assign(replies, at, end - at);
+            return true;
+        }
+
+        //! "rgb:RRRR/GGGG/BBBB" with 1 to 4 hex digits per component.
+        inline bool parse_rgb(std::string const& spec, uint8_t rgb[3])
+        {
+            if (spec.compare(0, 4, "rgb:") != 0)
+                return false;
+            size_t at = 4;
+            for (int c = 0; c < 3; ++c)
+            {
+                unsigned value = 0, digits = 0;
+                for (; at < spec.size() && spec[at] != '/'; ++at, ++digits)
+                {
+                    char ch = spec[at];
+                    unsigned d = ch >= '0' && ch <= '9' ? ch - '0' :
+                                 ch >= 'a' && ch <= 'f' ? ch - 'a' + 10 :
+                                 ch >= 'A' && ch <= 'F' ? ch - 'A' + 10 : 16u;
+                    if (d == 16)
+                        return false;
+                    value = value * 16 + d;
+                }
+                if (digits < 1 || digits > 4)
+                    return false;
+                unsigned max = (1u << (4 * digits)) - 1;
+                rgb[c] = static_cast<uint8_t>((value * 255 + max / 2) / max);
+                ++at;
+            }
+            return true;
+        }
+
+        //! Whether \a replies has the DA1 reply, "\033[?...c".
+        inline bool has_device_attributes(std::string const& replies)
+        {
+            for (size_t at = replies.find("\033[?"); at != std::string::npos; at = replies.find("\033[?", at + 1))
+            {
+                size_t p = at + 3;
+                while (p < replies.size() && ((replies[p] >= '0' && replies[p] <= '9') || replies[p] == ';'))
+                    ++p;
+                if (p < replies.size() && replies[p] == 'c')
+                    return true;
+            }
+            return false;
+        }
+
+        inline terminal_colors parse_replies(std::string const& replies)
+        {
+            terminal_colors colors;
+            std::memset(&colors, 0, sizeof(colors));
+            colors.depth = colors_unknown;
+            if (!has_device_attributes(replies))
+                return colors;
+            colors.answered = true;
+            colors.depth = colors_16;
+
+            std::string payload;
+            if (find_reply(replies, "\033]4;255;", payload))
+                colors.depth = colors_256;
+
+            // Either separator may be used, "48:2::1:2:3" included.
+            if (find_reply(replies, "\033P1$r", payload) &&
+                (payload.find("2;1;2;3") != std::string::npos ||
+                 payload.find("2:1:2:3") != std::string::npos ||
+                 payload.find("2::1:2:3") != std::string::npos))
+                colors.depth = colors_24bit;
+
+            if (find_reply(replies, "\033]10;", payload))
+                colors.has_foreground = parse_rgb(payload, colors.foreground);
+            if (find_reply(replies, "\033]11;", payload))
+                colors.has_background = parse_rgb(payload, colors.background);
+            return colors;
+        }
+    }
+
+    //! Query the terminal on \a out, reading its replies from \a in and
+    //! waiting at most \a timeout for them. Input typed meanwhile may be
+    //! consumed. Not cached; see `probe_terminal()`.
+    inline terminal_colors query_terminal(int out, int in, std::chrono::milliseconds timeout = std::chrono::milliseconds(100))
+    {
+        struct termios saved;
+        if (!::isatty(out) || !::isatty(in) || ::tcgetattr(in, &saved) != 0)
+            return _internal::parse_replies(std::string());
+
+        struct termios raw = saved;
+        raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+        raw.c_cc[VMIN]  = 0;
+        raw.c_cc[VTIME] = 0;
+        ::tcsetattr(in, TCSANOW, &raw);
+
+        std::string replies;
+        char const* query = _internal::probe_queries;
+        size_t left = sizeof(_internal::probe_queries) - 1;
+        while (left)
+        {
+            ssize_t n = ::write(out, query, left);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            query += n;
+            left  -= static_cast<size_t>(n);
+        }
+
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+        while (!left && !_internal::has_device_attributes(replies))
+        {
+            long wait = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count());
+            if (wait <= 0)
+                break;
+
+            struct pollfd p;
+            p.fd = in;
+            p.events = POLLIN;
+            p.revents = 0;
+            int ready = ::poll(&p, 1, static_cast<int>(wait));
+            if (ready < 0 && errno == EINTR)
+                continue;
+            if (ready <= 0)
+                break;
+
+            char buffer[256];
+            ssize_t n = ::read(in, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            replies.append(buffer, static_cast<size_t>(n));
+        }
+
+        // Replies still on their way would be read as typed input once
+        // the terminal is back in its mode, so what has arrived of them
+        // is dropped.
+        if (!_internal::has_device_attributes(replies))
+            ::tcflush(in, TCIFLUSH);
+        ::tcsetattr(in, TCSANOW, &saved);
+        return _internal::parse_replies(replies);
+    }
+
+    //! Query the terminal on \a fd, reading its replies from the
+    //! controlling terminal, or from stdin if there's none.
+    inline terminal_colors query_terminal(int fd, std::chrono::milliseconds timeout = std::chrono::milliseconds(100))
+    {
+        int in = ::open("/dev/tty", O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (in < 0)
+            return query_terminal(fd, STDIN_FILENO, timeout);
+        terminal_colors colors = query_terminal(fd, in, timeout);
+        ::close(in);
+        return colors;
+    }
+
+    //! Like `query_terminal()`, but only the first call for the terminal
+    //! on \a out asks it; later ones return the same answer, whichever
+    //! descriptor they pass. Replies are read from \a in, or as by
+    //! `query_terminal(out)` if it's negative.
+    inline terminal_colors probe_terminal(int out, int in, std::chrono::milliseconds timeout = std::chrono::milliseconds(100))
+    {
+        typedef std::tuple<uint64_t, uint64_t, int64_t, int64_t> terminal_id;
+        static std::mutex mutex;
+        static std::map<terminal_id, terminal_colors> cache;
+
+        struct stat info;
+        if (::fstat(out, &info) != 0)
+            return _internal::parse_replies(std::string());
+    #if defined(__APPLE__)
+        terminal_id id(info.st_dev, info.st_ino, info.st_ctimespec.tv_sec, info.st_ctimespec.tv_nsec);
+    #else
+        terminal_id id(info.st_dev, info.st_ino, info.st_ctim.tv_sec, info.st_ctim.tv_nsec);
+    #endif
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<terminal_id, terminal_colors>::iterator it = cache.find(id);
+        if (it == cache.end())
+            it = cache.insert(std::make_pair(id, in >= 0 ? query_terminal(out, in, timeout)
+                                                          : query_terminal(out, timeout))).first;
+        return it->second;
+    }
+
+    inline terminal_colors probe_terminal(int fd, std::chrono::milliseconds timeout = std::chrono::milliseconds(100))
+    {
+        return probe_terminal(fd, -1, timeout);
+    }
+
+    //! Limit the colors of `std::cout`, `std::cerr` or `std::clog` to
+    //! what their terminal answered. Other streams, and terminals that
+    //! didn't answer, are left as they are.
+    inline
+    std::ostream& probe(std::ostream& stream)
+    {
+        FILE* file = _internal::get_standard_stream(stream);
+        if (!file || !_internal::is_atty(stream))
+            return stream;
+
+        stream.flush();
+        terminal_colors colors = probe_terminal(fileno(file));
+        if (colors.depth != colors_unknown)
+            stream << max_colors(colors.depth);
+        return stream;
+    }
+
+} // namespace termcolor
+
+#endif // __unix__ || __unix || __APPLE__
+
+#endif // TERMCOLOR_PROBE_HPP_
@@ -0,0 +1,398 @@
+//!
+//! progress
+//! ~~~~~~~~
+//!
+//! "Progress" extends termcolor library by adding a multi-line progress
+//! renderer, i.e. a set of progress bars that are updated from many threads
+//! and redrawn by a single render thread at a capped frame rate.
+//!
+//! Updates are lock-free stores into per-bar slots, so worker threads never
+//! wait for the terminal. The render thread rewrites only bars whose
+//! displayed state has changed and moves between them with cursor-up/down
+//! sequences instead of clearing the screen. If the stream is not a tty the
+//! renderer falls back to periodic plain lines.
+//!
+//! Example.
+//!   progress bars(std::cout);
+//!   size_t job = bars.add("compiling", 200, style().green());
+//!   bars.start();
+//!   ... bars.advance(job); ...    // from any thread
+//!   bars.stop();
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_PROGRESS_HPP_
+#define TERMCOLOR_PROGRESS_HPP_
+
+#include <termcolor/style.hpp>
+#include <termcolor/width.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+namespace termcolor
+{
+    class progress
+    {
+        //! Hot per-bar counters. Each on a cache line of its own so that
+        //! threads updating neighbouring bars don't fight over the same
+        //! line.
+        struct alignas(64) counter
+        {
+            std::atomic<uint64_t> value;
+            std::atomic<uint64_t> total;
+        };
+
+        //! Cold per-bar data. Written once by `add()` before the bar is
+        //! published through `_count`, read-only afterwards.
+        struct bar
+        {
+            std::string label;
+            style       look;
+        };
+
+        //! What is currently on the screen for a bar. Owned by the thread
+        //! that renders.
+        struct shown
+        {
+            int percent;
+            int filled;
+        };
+
+    public:
+        //! \a capacity is the maximum number of bars, \a fps caps the
+        //! number of redraws per second for tty streams and \a interval is
+        //! the period of plain lines for non-tty streams.
+        explicit progress(std::ostream& stream, size_t capacity = 64,
+                          unsigned fps = 15,
+                          std::chrono::milliseconds interval = std::chrono::seconds(1))
+            : _stream(stream)
+            , _capacity(capacity)
+            , _counters(aligned_counters(_storage, capacity))
+            , _bars(capacity)
+            , _count(0)
+            , _frame(frame_period(fps))
+            , _interval(interval)
+            , _running(false)
+            , _tty(_internal::is_atty(stream))
+            , _colorized(_internal::is_colorized(stream))
+            , _drawn(0)
+            , _label_width(24)
+            , _bar_width(30)
+        {
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                _counters[i].value.store(0, std::memory_order_relaxed);
+                _counters[i].total.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        ~progress()
+        {
+            stop();
+        }
+
+        //! Width of the label column and of the bar itself, in characters.
+        progress& label_width(size_t width) { _label_width = width; return *this; }
+        progress& bar_width  (size_t width) { _bar_width   = width; return *this; }
+
+        //! Register a new bar and return its index. Returns `size_t(-1)`
+        //! if the capacity is exhausted.
+        size_t add(std::string const& label, uint64_t total, style const& look = style().green())
+        {
+            std::lock_guard<std::mutex> lock(_add_mutex);
+
+            size_t index = _count.load(std::memory_order_relaxed);
+            if (index == _capacity)
+                return size_t(-1);
+
+            _bars[index].label = label;
+            _bars[index].look  = look;
+            _counters[index].total.store(total, std::memory_order_relaxed);
+            _count.store(index + 1, std::memory_order_release);
+            return index;
+        }
+
+        //! Lock-free updates, safe to call from any thread.
+        void set(size_t index, uint64_t value)
+        {
+            _counters[index].value.store(value, std::memory_order_relaxed);
+        }
+
+        void advance(size_t index, uint64_t delta = 1)
+        {
+            _counters[index].value.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        void set_total(size_t index, uint64_t total)
+        {
+            _counters[index].total.store(total, std::memory_order_relaxed);
+        }
+
+        //! Launch the render thread.
+        void start()
+        {
+            std::lock_guard<std::mutex> lock(_run_mutex);
+            if (_running)
+                return;
+            _running = true;
+            _thread = std::thread(&progress::run, this);
+        }
+
+        //! Stop the render thread (if any) and draw the final state.
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_run_mutex);
+                if (_running)
+                {
+                    _running = false;
+                    _wakeup.notify_all();
+                }
+            }
+            if (_thread.joinable())
+                _thread.join();
+
+            render();
+        }
+
+        //! Draw one frame right now. Must not be called concurrently with
+        //! a running render thread; useful for single-threaded loops.
+        void render()
+        {
+            std::string out;
+            if (_tty)
+                frame(out);
+            else
+                lines(out);
+
+            if (!out.empty())
+            {
+                _stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+                _stream.flush();
+            }
+        }
+
+    private:
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(_run_mutex);
+            std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+            std::chrono::steady_clock::time_point plain = next + _interval;
+
+            while (_running)
+            {
+                // Don't try to catch up on frames missed by a slow terminal.
+                next = std::max(next + _frame, std::chrono::steady_clock::now());
+                _wakeup.wait_until(lock, next);
+                if (!_running)
+                    break;
+
+                // Non-tty streams get a line per bar only once an interval.
+                if (!_tty)
+                {
+                    if (std::chrono::steady_clock::now() < plain)
+                        continue;
+                    plain = std::chrono::steady_clock::now() + _interval;
+                }
+
+                lock.unlock();
+                render();
+                lock.lock();
+            }
+        }
+
+        shown measure(size_t index) const
+        {
+            uint64_t value = _counters[index].value.load(std::memory_order_relaxed);
+            uint64_t total = _counters[index].total.load(std::memory_order_relaxed);
+
+            shown s;
+            if (total == 0)
+            {
+                s.percent = 0;
+                s.filled  = 0;
+                return s;
+            }
+            if (value > total)
+                value = total;
+            s.percent = static_cast<int>(scale(value, total, 100));
+            s.filled  = static_cast<int>(scale(value, total, _bar_width));
+            return s;
+        }
+
+        //! \a value * \a n / \a total for \a value <= \a total, without
+        //! overflowing on large totals: then the product is summed up \a n
+        //! times into a remainder kept below \a total.
+        static uint64_t scale(uint64_t value, uint64_t total, uint64_t n)
+        {
+            if (!n || value <= uint64_t(-1) / n)
+                return value * n / total;
+            uint64_t quotient = 0, remainder = 0;
+            for (uint64_t i = 0; i < n; ++i)
+            {
+                if (remainder >= total - value)
+                {
+                    remainder -= total - value;
+                    ++quotient;
+                }
+                else
+                    remainder += value;
+            }
+            return quotient;
+        }
+
+        //! `new` aligns only to `max_align_t` before C++17, so the
+        //! counters' storage is aligned by hand.
+        static counter* aligned_counters(std::unique_ptr<char[]>& storage, size_t count)
+        {
+            size_t const align = alignof(counter);
+            storage.reset(new char[count * sizeof(counter) + align - 1]);
+            uintptr_t at = (reinterpret_cast<uintptr_t>(storage.get()) + align - 1) & ~static_cast<uintptr_t>(align - 1);
+            counter* counters = reinterpret_cast<counter*>(at);
+            for (size_t i = 0; i < count; ++i)
+                new (&counters[i]) counter();
+            return counters;
+        }
+
+        //! Time between redraws, counted in microseconds so that high
+        //! rates don't round down to a zero period (and a busy loop).
+        static std::chrono::steady_clock::duration frame_period(unsigned fps)
+        {
+            unsigned micros = 1000000u / (fps ? fps : 1);
+            return std::chrono::microseconds(micros ? micros : 1);
+        }
+
+        //! Cut and padded by columns, so that a label never ends in half
+        //! of a UTF-8 character.
+        void append_label(std::string& out, size_t index) const
+        {
+            std::string label = truncate(_bars[index].label, _label_width, std::string());
+            size_t width = display_width(label);
+            out += label;
+            if (width < _label_width)
+                out.append(_label_width - width, ' ');
+        }
+
+        void append_percent(std::string& out, int percent) const
+        {
+            if (percent < 100) out += ' ';
+            if (percent < 10)  out += ' ';
+            _internal::append_number(out, static_cast<uint64_t>(percent));
+            out += '%';
+        }
+
+        //! tty mode: rewrite changed lines in place. The cursor is kept on
+        //! the line right below the last bar between frames.
+        void frame(std::string& out)
+        {
+            size_t count = _count.load(std::memory_order_acquire);
+            size_t row = _drawn;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                shown now = measure(i);
+                if (i < _drawn && now.percent == _shown[i].percent && now.filled == _shown[i].filled)
+                    continue;
+
+                move(out, row, i);
+
+                append_label(out, i);
+                out += " [";
+                // An empty bar has nothing to color.
+                bool colored = _colorized && now.filled > 0;
+                if (colored)
+                    append(out, style(), _bars[i].look);
+                out.append(static_cast<size_t>(now.filled), '#');
+                if (colored)
+                    append(out, _bars[i].look, style());
+                out.append(_bar_width - static_cast<size_t>(now.filled), '.');
+                out += "] ";
+                append_percent(out, now.percent);
+                out += "\033[K\n";
+
+                row = i + 1;
+                if (i < _shown.size())
+                    _shown[i] = now;
+                else
+                    _shown.push_back(now);
+            }
+
+            move(out, row, count);
+            _drawn = count;
+        }
+
+        static void move(std::string& out, size_t from, size_t to)
+        {
+            if (from == to)
+                return;
+            out += "\033[";
+            _internal::append_number(out, from > to ? from - to : to - from);
+            out += from > to ? 'A' : 'B';
+        }
+
+        //! Non-tty mode: one plain line per bar whose percentage moved.
+        void lines(std::string& out)
+        {
+            size_t count = _count.load(std::memory_order_acquire);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                shown now = measure(i);
+                if (i < _shown.size() && now.percent == _shown[i].percent)
+                    continue;
+
+                append_label(out, i);
+                out += ' ';
+                append_percent(out, now.percent);
+                out += " (";
+                _internal::append_number(out, _counters[i].value.load(std::memory_order_relaxed));
+                out += '/';
+                _internal::append_number(out, _counters[i].total.load(std::memory_order_relaxed));
+                out += ")\n";
+
+                if (i < _shown.size())
+                    _shown[i] = now;
+                else
+                    _shown.push_back(now);
+            }
+        }
+
+    private:
+        std::ostream&               _stream;
+        size_t                      _capacity;
+        std::unique_ptr<char[]>     _storage;
+        counter*                    _counters;
+        std::vector<bar>            _bars;
+        std::atomic<size_t>         _count;
+        std::mutex                  _add_mutex;
+
+        std::chrono::steady_clock::duration _frame;
+        std::chrono::steady_clock::duration _interval;
+        std::mutex                  _run_mutex;
+        std::condition_variable     _wakeup;
+        std::thread                 _thread;
+        bool                        _running;
+
+        bool                        _tty;
+        bool                        _colorized;
+        size_t                      _drawn;
+        std::vector<shown>          _shown;
+        size_t                      _label_width;
+        size_t                      _bar_width;
+    };
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_PROGRESS_HPP_
@@ -0,0 +1,867 @@
+//!
+//! record
+//! ~~~~~~
+//!
+//! "Record" extends termcolor library by adding a recorder and a replayer
+//! of colored output, i.e. a compact binary format that keeps text runs
+//! and style changes apart, and a reader that turns it back into ANSI,
+//! plain text or HTML, from any point of the recording.
+//!
+//! A recording is a sequence of records: text runs (varint length and the
+//! bytes), uses of interned styles (varint id), definitions of new styles
+//! (id and SGR parameters) and timestamps (varint delta in microseconds).
+//! Every style is stored once no matter how often it is used, and a run
+//! in one of the first 240 styles carries the style id in its tag, so a
+//! color change costs one byte instead of the escape. A sparse
+//! index of checkpoints (file offset, text offset, time and style at the
+//! checkpoint), taken every so many bytes of text, and the style table go
+//! to the end of the file, so a replayer can seek straight to a text
+//! offset or a point in time. A recording cut short (no index) is still
+//! readable from the start.
+//!
+//! Example.
+//!   std::ofstream file("session.tcr", std::ios::binary);
+//!   recorder rec(file);
+//!   rec.feed(ansi_output, size);        // or rec.set_style(s).text("...")
+//!   rec.finish();
+//!
+//!   replayer rep(data, size);           // e.g. a mapped file
+//!   std::string html;
+//!   rep.render(html, replayer::html, rep.offset_at(std::chrono::seconds(60)));
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_RECORD_HPP_
+#define TERMCOLOR_RECORD_HPP_
+
+#include <termcolor/core.hpp>
+#include <termcolor/scan.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace termcolor
+{
+    namespace _internal
+    {
+        namespace record_format
+        {
+            //! "TCREC" and the format version.
+            static char const magic[8] = { 'T', 'C', 'R', 'E', 'C', '\0', '\1', '\n' };
+
+            //! The last 12 bytes: the file offset of the index record and
+            //! "TCIX".
+            static char const footer[4] = { 'T', 'C', 'I', 'X' };
+            static size_t const footer_size = 12;
+
+            enum tag
+            {   tag_text        = 1     // varint length, bytes
+            ,   tag_style       = 2     // varint id
+            ,   tag_define      = 3     // varint id, varint length, SGR parameters
+            ,   tag_time        = 4     // varint microseconds since the last one
+            ,   tag_index       = 5     // see recorder::finish()
+            ,   tag_run         = 16    // tag_run + id: a text run in style id
+            };
+
+            //! Styles that can be switched to by the tag of a text run.
+            static uint64_t const run_styles = 256 - tag_run;
+
+            inline void put_varint(std::string& out, uint64_t v)
+            {
+                while (v >= 0x80)
+                {
+                    out += static_cast<char>((v & 0x7f) | 0x80);
+                    v >>= 7;
+                }
+                out += static_cast<char>(v);
+            }
+
+            //! Decode a varint at \a p. Returns false if it runs past
+            //! \a last or is too long.
+            inline bool get_varint(char const*& p, char const* last, uint64_t& v)
+            {
+                v = 0;
+                for (int shift = 0; p != last && shift < 64; shift += 7)
+                {
+                    uint8_t byte = static_cast<uint8_t>(*p++);
+                    v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                    if (!(byte & 0x80))
+                        return true;
+                }
+                return false;
+            }
+
+            //! SGR parameters of the complete state \a s, e.g. "0;1;31".
+            inline std::string parameters(style const& s)
+            {
+                std::string sgr;
+                append(sgr, s);
+                return sgr.substr(2, sgr.size() - 3);
+            }
+        }
+    }
+
+    class recorder
+    {
+    public:
+        //! \a out should be opened in binary mode. A checkpoint is added to
+        //! the index every \a index_interval bytes of text.
+        explicit recorder(std::ostream& out, uint64_t index_interval = 1 << 16)
+            : _out(out)
+            , _interval(index_interval)
+            , _written(0)
+            , _text(0)
+            , _current(0)
+            , _recorded(0)
+            , _start(std::chrono::steady_clock::now())
+            , _time(0)
+            , _finished(false)
+        {
+            _buffer.append(_internal::record_format::magic, sizeof(_internal::record_format::magic));
+
+            // Id 0 is always the default state.
+            _styles.push_back(style());
+            _ids[style_key(style())] = 0;
+            _checkpoints.push_back(checkpoint(_buffer.size(), 0, 0, 0));
+        }
+
+        ~recorder()
+        {
+            finish();
+        }
+
+        //! Style of the text that follows.
+        recorder& set_style(style const& s)
+        {
+            if (s == _styles[_current])
+                return *this;
+
+            std::pair<std::unordered_map<uint64_t, size_t>::iterator, bool> interned =
+                _ids.insert(std::make_pair(style_key(s), _styles.size()));
+            if (interned.second)
+                _styles.push_back(s);
+            _current = interned.first->second;
+            return *this;
+        }
+
+        //! Record plain text (escape sequences in it are kept as they are).
+        recorder& text(char const* p, size_t size)
+        {
+            stamp();
+            put_text(p, size);
+            return *this;
+        }
+
+        recorder& text(std::string const& s)
+        {
+            return text(s.data(), s.size());
+        }
+
+        //! Record raw terminal output: SGR sequences become style changes,
+        //! everything else is text. Sequences may be split between calls.
+        recorder& feed(char const* p, size_t size)
+        {
+            stamp();
+            if (!_partial.empty())
+            {
+                _partial.append(p, size);
+                std::string pending;
+                pending.swap(_partial);
+                parse(pending.data(), pending.data() + pending.size());
+                return *this;
+            }
+            parse(p, p + size);
+            return *this;
+        }
+
+        recorder& feed(std::string const& s)
+        {
+            return feed(s.data(), s.size());
+        }
+
+        //! Write the index and the footer. Nothing can be recorded after.
+        void finish()
+        {
+            if (_finished)
+                return;
+            if (!_partial.empty())
+            {
+                put_text(_partial.data(), _partial.size());
+                _partial.clear();
+            }
+
+            namespace f = _internal::record_format;
+            uint64_t index_offset = _written + _buffer.size();
+
+            // Index: styles (count, then length and SGR parameters of
+            // each), checkpoints (count, then deltas of file offset, text
+            // offset, time, and the style id), total text and time.
+            _buffer += static_cast<char>(f::tag_index);
+            f::put_varint(_buffer, _styles.size());
+            for (size_t id = 0; id < _styles.size(); ++id)
+            {
+                std::string sgr = f::parameters(_styles[id]);
+                f::put_varint(_buffer, sgr.size());
+                _buffer += sgr;
+            }
+
+            f::put_varint(_buffer, _checkpoints.size());
+            checkpoint last(0, 0, 0, 0);
+            for (size_t i = 0; i < _checkpoints.size(); ++i)
+            {
+                checkpoint const& c = _checkpoints[i];
+                f::put_varint(_buffer, c.offset - last.offset);
+                f::put_varint(_buffer, c.text - last.text);
+                f::put_varint(_buffer, c.time - last.time);
+                f::put_varint(_buffer, c.style);
+                last = c;
+            }
+            f::put_varint(_buffer, _text);
+            f::put_varint(_buffer, _time);
+
+            for (int i = 0; i < 8; ++i)
+                _buffer += static_cast<char>(index_offset >> (8 * i) & 0xff);
+            _buffer.append(f::footer, sizeof(f::footer));
+
+            flush();
+            _out.flush();
+            _finished = true;
+        }
+
+    private:
+        struct checkpoint
+        {
+            checkpoint(uint64_t offset_, uint64_t text_, uint64_t time_, uint64_t style_)
+                : offset(offset_), text(text_), time(time_), style(style_) {}
+
+            uint64_t offset, text, time, style;
+        };
+
+        void parse(char const* p, char const* last)
+        {
+            while (p != last)
+            {
+                char const* esc = static_cast<char const*>(std::memchr(p, '\033', static_cast<size_t>(last - p)));
+                if (!esc)
+                {
+                    put_text(p, static_cast<size_t>(last - p));
+                    return;
+                }
+                put_text(p, static_cast<size_t>(esc - p));
+
+                size_t length = _internal::escape_length(esc, last);
+                if (!_internal::escape_complete(esc, length, last))
+                {
+                    _partial.assign(esc, last);
+                    return;
+                }
+
+                if (_internal::is_sgr(esc, length))
+                {
+                    style s = _styles[_current];
+                    s.apply(esc + 2, length - 3);
+                    set_style(s);
+                }
+                else
+                    put_text(esc, length);
+                p = esc + length;
+            }
+        }
+
+        //! Timestamps are written at most once a millisecond, and looked up
+        //! once per call rather than per run.
+        void stamp()
+        {
+            uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - _start).count());
+            if (now - _time < 1000)
+                return;
+            _buffer += static_cast<char>(_internal::record_format::tag_time);
+            _internal::record_format::put_varint(_buffer, now - _time);
+            _time = now;
+        }
+
+        //! One text record, in the current style. Runs go straight into
+        //! the output buffer (large ones straight to the stream) rather
+        //! than being merged first.
+        void put_text(char const* p, size_t size)
+        {
+            namespace f = _internal::record_format;
+            if (!size)
+                return;
+
+            if (_text - _checkpoints.back().text >= _interval)
+                _checkpoints.push_back(checkpoint(_written + _buffer.size(), _text, _time, _recorded));
+
+            if (_current == _recorded)
+                _buffer += static_cast<char>(f::tag_text);
+            else if (!define() && _current < f::run_styles)
+                _buffer += static_cast<char>(f::tag_run + _current);
+            else
+            {
+                if (_current != _recorded)
+                {
+                    _buffer += static_cast<char>(f::tag_style);
+                    f::put_varint(_buffer, _current);
+                }
+                _buffer += static_cast<char>(f::tag_text);
+            }
+            _recorded = _current;
+            f::put_varint(_buffer, size);
+            _text += size;
+
+            if (size >= (1 << 16))
+            {
+                flush();
+                _out.write(p, static_cast<std::streamsize>(size));
+                _written += size;
+                return;
+            }
+            _buffer.append(p, size);
+            if (_buffer.size() >= (1 << 16))
+                flush();
+        }
+
+        //! Write the definition of the current style if it is new; the
+        //! definition switches to it. Returns whether it was written.
+        bool define()
+        {
+            namespace f = _internal::record_format;
+            if (_current < _defined.size() && _defined[_current])
+                return false;
+            if (_defined.size() <= _current)
+                _defined.resize(_current + 1, false);
+            _defined[_current] = true;
+
+            std::string sgr = f::parameters(_styles[_current]);
+            _buffer += static_cast<char>(f::tag_define);
+            f::put_varint(_buffer, _current);
+            f::put_varint(_buffer, sgr.size());
+            _buffer += sgr;
+            _recorded = _current;
+            return true;
+        }
+
+        void flush()
+        {
+            _out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+            _written += _buffer.size();
+            _buffer.clear();
+        }
+
+    private:
+        std::ostream&               _out;
+        uint64_t                    _interval;
+        std::string                 _buffer;
+        std::string                 _partial;
+        uint64_t                    _written;
+        uint64_t                    _text;
+
+        std::vector<style>          _styles;
+        std::unordered_map<uint64_t, size_t> _ids;     // style_key() to id
+        std::vector<bool>           _defined;
+        size_t                      _current;
+        size_t                      _recorded;
+
+        std::vector<checkpoint>     _checkpoints;
+        std::chrono::steady_clock::time_point _start;
+        uint64_t                    _time;
+        bool                        _finished;
+    };
+
+    class replayer
+    {
+        struct checkpoint
+        {
+            uint64_t offset, text, time, style;
+        };
+
+    public:
+        enum format
+        {   ansi
+        ,   plain
+        ,   html
+        };
+
+        //! \a data must stay valid while the replayer is used.
+        replayer(char const* data, size_t size)
+            : _data(data)
+            , _size(size)
+            , _end(size)
+            , _text(0)
+            , _time(0)
+            , _valid(false)
+        {
+            namespace f = _internal::record_format;
+            if (size < sizeof(f::magic) || std::memcmp(data, f::magic, sizeof(f::magic)) != 0)
+                return;
+            _valid = true;
+            if (!read_index())
+                scan_all();
+        }
+
+        bool valid() const { return _valid; }
+
+        //! Bytes of text and microseconds covered by the recording.
+        uint64_t text_size() const { return _text; }
+        uint64_t duration()  const { return _time; }
+
+        //! Text offset of the first text recorded at or after \a time.
+        uint64_t offset_at(std::chrono::microseconds time) const
+        {
+            uint64_t t = static_cast<uint64_t>(time.count());
+            size_t i = _checkpoints.size();
+            while (i > 1 && _checkpoints[i - 1].time > t)
+                --i;
+            if (!i)
+                return 0;
+
+            position at = start(_checkpoints[i - 1]);
+            while (next(at))
+                if (at.tag == _internal::record_format::tag_text && at.time >= t)
+                    return at.text;
+            return _text;
+        }
+
+        //! Call `on_run(style const&, char const*, size_t, uint64_t
+        //! microseconds)` for the text in [\a from, \a to), piece by piece.
+        template <typename OnRun>
+        void for_each_run(uint64_t from, uint64_t to, OnRun on_run) const
+        {
+            by_style<OnRun> adapter = { &_styles, &on_run };
+            runs(from, to, adapter);
+        }
+
+        //! Append the text in [\a from, \a to) to \a out. ANSI output
+        //! starts from the default state and returns to it at the end;
+        //! HTML is a fragment of spans to be put into a <pre>.
+        void render(std::string& out, format f, uint64_t from = 0, uint64_t to = uint64_t(-1)) const
+        {
+            if (!_valid || from >= to)
+                return;
+            render_state state(out, f, _styles);
+            runs(from, to, state);
+            state.close();
+        }
+
+    private:
+        template <typename OnRun>
+        struct by_style
+        {
+            std::vector<style> const*   styles;
+            OnRun*                      on_run;
+
+            void operator()(size_t id, char const* p, size_t size, uint64_t time) const
+            {
+                (*on_run)((*styles)[id], p, size, time);
+            }
+        };
+
+        //! Like `for_each_run()`, with style ids instead of styles.
+        template <typename OnRun>
+        void runs(uint64_t from, uint64_t to, OnRun& on_run) const
+        {
+            if (!_valid || from >= to)
+                return;
+
+            size_t i = _checkpoints.size();
+            while (i > 1 && _checkpoints[i - 1].text > from)
+                --i;
+            if (!i)
+                return;
+
+            position at = start(_checkpoints[i - 1]);
+            while (at.text < to && next(at))
+            {
+                if (at.tag != _internal::record_format::tag_text)
+                    continue;
+                uint64_t first = at.text - at.size, last = at.text;
+                if (last <= from)
+                    continue;
+                uint64_t skip = from > first ? from - first : 0;
+                uint64_t keep = (to < last ? to : last) - first - skip;
+                on_run(static_cast<size_t>(at.style), at.run + skip, static_cast<size_t>(keep), at.time);
+            }
+        }
+
+        //! A cursor over the records.
+        struct position
+        {
+            char const* p;
+            uint64_t    text;       // text offset past the current record
+            uint64_t    time;
+            uint64_t    style;
+            int         tag;
+            char const* run;        // the current text record
+            uint64_t    size;
+        };
+
+        position start(checkpoint const& c) const
+        {
+            position at;
+            at.p     = _data + c.offset;
+            at.text  = c.text;
+            at.time  = c.time;
+            at.style = c.style;
+            at.tag   = 0;
+            at.run   = 0;
+            at.size  = 0;
+            return at;
+        }
+
+        //! Step over one record. Returns false at the end or on damage.
+        bool next(position& at) const
+        {
+            namespace f = _internal::record_format;
+            char const* last = _data + _end;
+            if (at.p >= last)
+                return false;
+
+            at.tag = static_cast<uint8_t>(*at.p++);
+            uint64_t v;
+            if (!f::get_varint(at.p, last, v))
+                return false;
+
+            if (at.tag >= f::tag_run)
+            {
+                at.style = static_cast<uint64_t>(at.tag - f::tag_run);
+                if (at.style >= _styles.size())
+                    return false;
+                at.tag = f::tag_text;
+            }
+
+            switch (at.tag)
+            {
+                case f::tag_text:
+                    if (v > static_cast<uint64_t>(last - at.p))
+                        return false;
+                    at.run  = at.p;
+                    at.size = v;
+                    at.text += v;
+                    at.p    += v;
+                    return true;
+
+                case f::tag_style:
+                    if (v >= _styles.size())
+                        return false;
+                    at.style = v;
+                    return true;
+
+                case f::tag_define:
+                {
+                    uint64_t length;
+                    if (v >= _styles.size() || !f::get_varint(at.p, last, length) ||
+                        length > static_cast<uint64_t>(last - at.p))
+                        return false;
+                    at.style = v;
+                    at.p += length;
+                    return true;
+                }
+
+                case f::tag_time:
+                    at.time += v;
+                    return true;
+
+                default:
+                    return false;
+            }
+        }
+
+        bool read_index()
+        {
+            namespace f = _internal::record_format;
+            if (_size < sizeof(f::magic) + f::footer_size ||
+                std::memcmp(_data + _size - sizeof(f::footer), f::footer, sizeof(f::footer)) != 0)
+                return false;
+
+            uint64_t offset = 0;
+            for (int i = 0; i < 8; ++i)
+                offset |= static_cast<uint64_t>(static_cast<uint8_t>(_data[_size - f::footer_size + i])) << (8 * i);
+            if (offset < sizeof(f::magic) || offset >= _size - f::footer_size || _data[offset] != f::tag_index)
+                return false;
+
+            char const* p = _data + offset + 1;
+            char const* last = _data + _size - f::footer_size;
+
+            uint64_t count;
+            if (!f::get_varint(p, last, count) || count > static_cast<uint64_t>(last - p))
+                return false;
+            for (uint64_t id = 0; id < count; ++id)
+            {
+                uint64_t length;
+                if (!f::get_varint(p, last, length) || length > static_cast<uint64_t>(last - p))
+                    return false;
+                _styles.push_back(style().apply(p, static_cast<size_t>(length)));
+                p += length;
+            }
+
+            if (!f::get_varint(p, last, count) || count > static_cast<uint64_t>(last - p))
+                return false;
+            checkpoint c = { 0, 0, 0, 0 };
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                uint64_t offset_delta, text_delta, time_delta;
+                if (!f::get_varint(p, last, offset_delta) || !f::get_varint(p, last, text_delta) ||
+                    !f::get_varint(p, last, time_delta) || !f::get_varint(p, last, c.style))
+                    return false;
+                c.offset += offset_delta;
+                c.text   += text_delta;
+                c.time   += time_delta;
+                if (c.offset > offset || c.style >= _styles.size())
+                    return false;
+                _checkpoints.push_back(c);
+            }
+
+            if (!f::get_varint(p, last, _text) || !f::get_varint(p, last, _time))
+                return false;
+            _end = static_cast<size_t>(offset);
+            return true;
+        }
+
+        //! No index: collect the styles in one pass and read from the
+        //! start only.
+        void scan_all()
+        {
+            namespace f = _internal::record_format;
+            _styles.assign(1, style());
+            _checkpoints.clear();
+            _end = _size;
+
+            char const* p = _data + sizeof(f::magic);
+            char const* last = _data + _size;
+            while (p < last)
+            {
+                int tag = static_cast<uint8_t>(*p++);
+                uint64_t v, length;
+                if (!f::get_varint(p, last, v))
+                    break;
+                if (tag == f::tag_text || tag >= f::tag_run)
+                {
+                    if (v > static_cast<uint64_t>(last - p))
+                        break;
+                    p += v;
+                    _text += v;
+                }
+                else if (tag == f::tag_define)
+                {
+                    if (!f::get_varint(p, last, length) || length > static_cast<uint64_t>(last - p))
+                        break;
+                    if (v >= _styles.size())
+                        _styles.resize(static_cast<size_t>(v) + 1);
+                    _styles[static_cast<size_t>(v)] = style().apply(p, static_cast<size_t>(length));
+                    p += length;
+                }
+                else if (tag == f::tag_time)
+                    _time += v;
+                else if (tag != f::tag_style)
+                    break;
+            }
+
+            checkpoint c = { sizeof(f::magic), 0, 0, 0 };
+            _checkpoints.push_back(c);
+        }
+
+        //! Writes runs in one of the formats, tracking what is displayed.
+        //! Transitions between styles (for up to 64 styles) and the span
+        //! tags are computed once each and then copied.
+        class render_state
+        {
+        public:
+            render_state(std::string& out, format f, std::vector<style> const& styles)
+                : _out(out), _format(f), _styles(styles), _shown(0), _span(false)
+            {
+                if (_format == ansi && _styles.size() <= 64)
+                    _transitions.resize(_styles.size() * _styles.size());
+                else if (_format == html)
+                    _spans.resize(_styles.size());
+            }
+
+            void operator()(size_t id, char const* p, size_t size, uint64_t)
+            {
+                if (_format == ansi)
+                {
+                    if (id != _shown)
+                        transition(id);
+                    _out.append(p, size);
+                    return;
+                }
+
+                if (_format == html && id != _shown)
+                {
+                    if (_span)
+                        _out += "</span>";
+                    _span = !(_styles[id] == style());
+                    if (_span)
+                    {
+                        std::string& tag = _spans[id];
+                        if (tag.empty())
+                        {
+                            tag = "<span style=\"";
+                            css(tag, _styles[id]);
+                            tag += "\">";
+                        }
+                        _out += tag;
+                    }
+                    _shown = id;
+                }
+                text(p, p + size);
+            }
+
+            void close()
+            {
+                if (_format == ansi)
+                    append(_out, _styles[_shown], style());
+                else if (_span)
+                    _out += "</span>";
+            }
+
+        private:
+            void transition(size_t id)
+            {
+                if (_transitions.empty())
+                    append(_out, _styles[_shown], _styles[id]);
+                else
+                {
+                    std::string& t = _transitions[_shown * _styles.size() + id];
+                    if (t.empty())
+                        append(t, _styles[_shown], _styles[id]);
+                    _out += t;
+                }
+                _shown = id;
+            }
+
+            //! Plain and HTML output drop escapes other than SGR too.
+            void text(char const* p, char const* last)
+            {
+                while (p != last)
+                {
+                    char const* q;
+                    if (_format == html)
+                        q = _internal::find_any(p, last, '\033', '<', '>', '&');
+                    else
+                    {
+                        q = static_cast<char const*>(std::memchr(p, '\033', static_cast<size_t>(last - p)));
+                        if (!q)
+                            q = last;
+                    }
+                    _out.append(p, q);
+                    if (q == last)
+                        return;
+
+                    switch (*q)
+                    {
+                        case '<':  _out += "&lt;";   break;
+                        case '>':  _out += "&gt;";   break;
+                        case '&':  _out += "&amp;";  break;
+                        default:
+                            p = q + _internal::escape_length(q, last);
+                            continue;
+                    }
+                    p = q + 1;
+                }
+            }
+
+            static void hex(std::string& out, uint32_t rgb)
+            {
+                static char const digits[] = "0123456789abcdef";
+                out += '#';
+                for (int shift = 20; shift >= 0; shift -= 4)
+                    out += digits[rgb >> shift & 0xf];
+            }
+
+            //! CSS of a complete state, read back from its SGR parameters.
+            static void css(std::string& out, style const& s)
+            {
+                std::string sgr = _internal::record_format::parameters(s);
+                std::vector<unsigned> values(1, 0);
+                for (size_t i = 0; i < sgr.size(); ++i)
+                    if (sgr[i] == ';')
+                        values.push_back(0);
+                    else
+                        values.back() = values.back() * 10 + static_cast<unsigned>(sgr[i] - '0');
+
+                bool bold = false, dark = false, underline = false, blink = false, reverse = false, hidden = false;
+                bool has_fg = false, has_bg = false;
+                uint32_t fg = 0, bg = 0;
+                for (size_t i = 0; i < values.size(); ++i)
+                {
+                    unsigned v = values[i];
+                    if      (v == 1) bold = true;
+                    else if (v == 2) dark = true;
+                    else if (v == 4) underline = true;
+                    else if (v == 5) blink = true;
+                    else if (v == 7) reverse = true;
+                    else if (v == 8) hidden = true;
+                    else if (v >= 30 && v <= 37) { has_fg = true; fg = palette_color(static_cast<uint8_t>(v - 30)); }
+                    else if (v >= 40 && v <= 47) { has_bg = true; bg = palette_color(static_cast<uint8_t>(v - 40)); }
+                    else if (v >= 90 && v <= 97)   { has_fg = true; fg = palette_color(static_cast<uint8_t>(v - 90 + 8)); }
+                    else if (v >= 100 && v <= 107) { has_bg = true; bg = palette_color(static_cast<uint8_t>(v - 100 + 8)); }
+                    else if ((v == 38 || v == 48) && i + 1 < values.size())
+                    {
+                        uint32_t rgb;
+                        if (values[i + 1] == 5 && i + 2 < values.size())
+                        {
+                            rgb = palette_color(static_cast<uint8_t>(values[i + 2]));
+                            i += 2;
+                        }
+                        else if (values[i + 1] == 2 && i + 4 < values.size())
+                        {
+                            rgb = values[i + 2] << 16 | values[i + 3] << 8 | values[i + 4];
+                            i += 4;
+                        }
+                        else
+                            break;
+                        (v == 38 ? has_fg : has_bg) = true;
+                        (v == 38 ? fg : bg) = rgb;
+                    }
+                }
+
+                std::string color = has_fg ? std::string() : "CanvasText";
+                std::string background = has_bg ? std::string() : "Canvas";
+                if (has_fg) hex(color, fg);
+                if (has_bg) hex(background, bg);
+                if (reverse)
+                    color.swap(background);
+
+                if (has_fg || reverse)   { out += "color:"; out += color; out += ';'; }
+                if (has_bg || reverse)   { out += "background:"; out += background; out += ';'; }
+                if (bold)                out += "font-weight:bold;";
+                if (dark)                out += "opacity:0.7;";
+                if (underline || blink)
+                {
+                    out += "text-decoration:";
+                    out += underline && blink ? "underline blink;" : underline ? "underline;" : "blink;";
+                }
+                if (hidden)              out += "visibility:hidden;";
+            }
+
+        private:
+            std::string&                _out;
+            format                      _format;
+            std::vector<style> const&   _styles;
+            size_t                      _shown;
+            bool                        _span;
+            std::vector<std::string>    _transitions;
+            std::vector<std::string>    _spans;
+        };
+
+    private:
+        char const*                 _data;
+        size_t                      _size;
+        size_t                      _end;
+        std::vector<style>          _styles;
+        std::vector<checkpoint>     _checkpoints;
+        uint64_t                    _text;
+        uint64_t                    _time;
+        bool                        _valid;
+    };
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_RECORD_HPP_
@@ -0,0 +1,314 @@
+//!
+//! report
+//! ~~~~~~
+//!
+//! "Report" extends termcolor library by adding a parallel report builder,
+//! i.e. an object that renders a large colored report in chunks on many
+//! threads and writes the chunks to a file descriptor in their order.
+//!
+//! Every worker formats chunks with an ordinary `std::ostream`, so the
+//! manipulators and `style` work as usual, into a buffer of its own. Each
+//! chunk starts from the default state and, if it leaves some style
+//! active, gets a reset appended, so colors are right at chunk boundaries
+//! no matter which thread rendered what. The calling thread commits
+//! finished chunks in sequence, batching consecutive ones into a single
+//! writev. Chunk buffers are reused, and workers never run more than a
+//! window of chunks ahead of the committer.
+//!
+//! Example.
+//!   report_builder report(STDOUT_FILENO);
+//!   report.run(rows / 4096, [&](std::ostream& out, size_t chunk) {
+//!       for (size_t i = chunk * 4096; i < (chunk + 1) * 4096; ++i)
+//!           out << green << "PASS" << reset << " test " << i << "\n";
+//!   });
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_REPORT_HPP_
+#define TERMCOLOR_REPORT_HPP_
+
+#include <termcolor/termcolor.hpp>
+
+#if defined(__unix__) || defined(__unix) || defined(__APPLE__)
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace termcolor
+{
+    namespace _internal
+    {
+        //! A stream buffer appending straight to a string, without the
+        //! copy `std::ostringstream::str()` makes.
+        class string_appender : public std::streambuf
+        {
+        public:
+            string_appender() : _target(0) {}
+
+            void target(std::string* s) { _target = s; }
+
+        protected:
+            std::streamsize xsputn(char const* p, std::streamsize n)
+            {
+                _target->append(p, static_cast<size_t>(n));
+                return n;
+            }
+
+            int_type overflow(int_type c)
+            {
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                    _target->push_back(traits_type::to_char_type(c));
+                return traits_type::not_eof(c);
+            }
+
+        private:
+            std::string* _target;
+        };
+    }
+
+    class report_builder
+    {
+        struct slot
+        {
+            std::string text;
+            bool        ready;
+        };
+
+    public:
+        //! Colors are on if \a fd is a terminal, as for `std::cout`.
+        explicit report_builder(int fd = STDOUT_FILENO)
+            : _fd(fd)
+            , _workers(0)
+            , _window(0)
+            , _colors(::isatty(fd) != 0)
+            , _written(0)
+            , _writes(0)
+        {
+        }
+
+        //! Number of rendering threads, 0 for one per hardware thread.
+        report_builder& workers(unsigned n) { _workers = n; return *this; }
+
+        //! How many chunks may be rendered ahead of the one being written,
+        //! 0 for four per worker. Bounds the memory in use.
+        report_builder& window(size_t chunks) { _window = chunks; return *this; }
+
+        //! Force colors on or off, like `colorize` / `nocolorize`.
+        report_builder& colors(bool on) { _colors = on; return *this; }
+
+        //! Bytes written and writev calls made by the last `run()`.
+        uint64_t written() const { return _written; }
+        uint64_t writes()  const { return _writes; }
+
+        //! Render chunks 0 .. \a chunks - 1 with `render(std::ostream&,
+        //! size_t chunk)` on the workers and write them in order. Returns
+        //! false if writing failed; an exception thrown by \a render stops
+        //! the run and is rethrown here.
+        template <typename Render>
+        bool run(size_t chunks, Render render)
+        {
+            unsigned workers = _workers ? _workers : std::thread::hardware_concurrency();
+            if (!workers)
+                workers = 1;
+            size_t window = _window ? _window : 4 * workers;
+
+            _slots.resize(window);
+            for (size_t i = 0; i < window; ++i)
+                _slots[i].ready = false;
+            _next.store(0);
+            _committed = 0;
+            _failed = false;
+            _error = std::exception_ptr();
+            _written = 0;
+            _writes = 0;
+
+            std::vector<std::thread> pool;
+            for (unsigned w = 0; w < workers; ++w)
+                pool.push_back(std::thread(&report_builder::work<Render>, this, chunks, window, &render));
+
+            bool ok = commit(chunks, window);
+
+            for (size_t w = 0; w < pool.size(); ++w)
+                pool[w].join();
+            if (_error)
+                std::rethrow_exception(_error);
+            return ok;
+        }
+
+    private:
+        template <typename Render>
+        void work(size_t chunks, size_t window, Render* render)
+        {
+            _internal::string_appender buffer;
+            std::ostream out(&buffer);
+            out << (_colors ? colorize : nocolorize);
+
+            for (;;)
+            {
+                size_t i = _next.fetch_add(1);
+                if (i >= chunks)
+                    return;
+
+                slot& s = _slots[i % window];
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _free.wait(lock, [&] { return i < _committed + window || _failed; });
+                    if (_failed)
+                        return;
+                }
+
+                s.text.clear();
+                buffer.target(&s.text);
+                out.clear();
+                try
+                {
+                    (*render)(out, i);
+                    out.flush();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (!_error)
+                        _error = std::current_exception();
+                    _failed = true;
+                    _free.notify_all();
+                    _ready.notify_all();
+                    return;
+                }
+                close(s.text);
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                s.ready = true;
+                if (i == _committed)
+                    _ready.notify_one();
+            }
+        }
+
+        //! Append a reset unless the chunk is known to end in the default
+        //! state, i.e. it has no escapes or its last escape is a reset.
+        static void close(std::string& text)
+        {
+            size_t esc = text.rfind('\033');
+            if (esc == std::string::npos)
+                return;
+            char const* p = text.data() + esc + 1;
+            size_t left = text.size() - esc - 1;
+            if ((left >= 2 && std::memcmp(p, "[m", 2) == 0) ||
+                (left >= 3 && std::memcmp(p, "[0m", 3) == 0) ||
+                (left >= 4 && std::memcmp(p, "[00m", 4) == 0))
+                return;
+            text += "\033[0m";
+        }
+
+        //! Write finished chunks in order, batching consecutive ones.
+        bool commit(size_t chunks, size_t window)
+        {
+            while (true)
+            {
+                size_t first, last;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    if (_committed == chunks)
+                        return true;
+                    _ready.wait(lock, [&] { return _slots[_committed % window].ready || _failed; });
+                    if (_failed)
+                        return true;
+
+                    first = last = _committed;
+                    while (last < chunks && last - first < window && _slots[last % window].ready)
+                        ++last;
+                }
+
+                bool ok = write(first, last, window);
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                for (size_t i = first; i < last; ++i)
+                    _slots[i % window].ready = false;
+                _committed = last;
+                _free.notify_all();
+                if (!ok)
+                {
+                    _failed = true;
+                    return false;
+                }
+            }
+        }
+
+        bool write(size_t first, size_t last, size_t window)
+        {
+            std::vector<iovec> chunks;
+            for (size_t i = first; i < last; ++i)
+            {
+                std::string& text = _slots[i % window].text;
+                if (text.empty())
+                    continue;
+                iovec v;
+                v.iov_base = &text[0];
+                v.iov_len  = text.size();
+                chunks.push_back(v);
+            }
+
+            // Partial writes are continued from where they stopped.
+            size_t at = 0;
+            while (at < chunks.size())
+            {
+                int count = static_cast<int>(std::min<size_t>(chunks.size() - at, 1024));
+                ssize_t n = ::writev(_fd, &chunks[at], count);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+                ++_writes;
+                _written += static_cast<uint64_t>(n);
+
+                size_t done = static_cast<size_t>(n);
+                while (at < chunks.size() && done >= chunks[at].iov_len)
+                    done -= chunks[at++].iov_len;
+                if (done)
+                {
+                    chunks[at].iov_base = static_cast<char*>(chunks[at].iov_base) + done;
+                    chunks[at].iov_len -= done;
+                }
+            }
+            return true;
+        }
+
+    private:
+        int                         _fd;
+        unsigned                    _workers;
+        size_t                      _window;
+        bool                        _colors;
+        uint64_t                    _written;
+        uint64_t                    _writes;
+
+        std::vector<slot>           _slots;
+        std::atomic<size_t>         _next;
+        std::mutex                  _mutex;
+        std::condition_variable     _free;
+        std::condition_variable     _ready;
+        size_t                      _committed;
+        bool                        _failed;
+        std::exception_ptr          _error;
+    };
+
+} // namespace termcolor
+
+#endif // __unix__ || __unix || __APPLE__
+
+#endif // TERMCOLOR_REPORT_HPP_
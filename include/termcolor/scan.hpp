@@ -0,0 +1,207 @@
+//!
+//! scan
+//! ~~~~
+//!
+//! "Scan" is an internal part of termcolor library that provides byte
+//! scanning primitives shared by the renderers, i.e. searching for runs of
+//! plain text between escape sequences, line breaks and other delimiters.
+//!
+//! On x86 the scans look at 16 bytes at a time with SSE2, elsewhere they
+//! fall back to a plain loop. The results are the same on every platform.
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_SCAN_HPP_
+#define TERMCOLOR_SCAN_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define TERMCOLOR_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace termcolor
+{
+    namespace _internal
+    {
+        //! Index of the lowest set bit of a non-zero mask.
+        inline
+        unsigned lowest_bit(unsigned mask)
+        {
+        #if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+        #else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+        #endif
+        }
+
+        //! Length of the leading run of printable ASCII (0x20..0x7E), i.e.
+        //! bytes that are exactly one column wide and need no decoding.
+        inline
+        size_t printable_ascii_run(char const* first, char const* last)
+        {
+            char const* p = first;
+
+        #if defined(TERMCOLOR_SSE2)
+            // Signed compare: bytes >= 0x80 are negative and thus caught by
+            // the same "less than 0x20" test as control characters.
+            __m128i const space = _mm_set1_epi8(0x20);
+            __m128i const del   = _mm_set1_epi8(0x7f);
+            while (last - p >= 16)
+            {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+                __m128i bad = _mm_or_si128(_mm_cmplt_epi8(chunk, space), _mm_cmpeq_epi8(chunk, del));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(bad));
+                if (mask)
+                    return static_cast<size_t>(p - first) + lowest_bit(mask);
+                p += 16;
+            }
+        #endif
+
+            while (p != last && static_cast<unsigned char>(*p) >= 0x20 && *p != 0x7f
+                             && static_cast<unsigned char>(*p) < 0x80)
+                ++p;
+            return static_cast<size_t>(p - first);
+        }
+
+        //! Find the first byte equal to any of \a a, \a b, \a c, \a d (pass
+        //! the same byte several times to look for fewer). Returns \a last
+        //! if there is none.
+        inline
+        char const* find_any(char const* p, char const* last, char a, char b, char c, char d)
+        {
+        #if defined(TERMCOLOR_SSE2)
+            __m128i const va = _mm_set1_epi8(a);
+            __m128i const vb = _mm_set1_epi8(b);
+            __m128i const vc = _mm_set1_epi8(c);
+            __m128i const vd = _mm_set1_epi8(d);
+            while (last - p >= 16)
+            {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+                __m128i hit = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)),
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, vc), _mm_cmpeq_epi8(chunk, vd)));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+                if (mask)
+                    return p + lowest_bit(mask);
+                p += 16;
+            }
+        #endif
+
+            for (; p != last; ++p)
+                if (*p == a || *p == b || *p == c || *p == d)
+                    return p;
+            return last;
+        }
+
+        inline
+        char const* find_any(char const* p, char const* last, char a, char b)
+        {
+            return find_any(p, last, a, b, b, b);
+        }
+
+        //! Skip bytes equal to any of \a a, \a b, \a c, \a d. Returns the
+        //! first byte that is none of them, or \a last.
+        inline
+        char const* skip_any(char const* p, char const* last, char a, char b, char c, char d)
+        {
+        #if defined(TERMCOLOR_SSE2)
+            __m128i const va = _mm_set1_epi8(a);
+            __m128i const vb = _mm_set1_epi8(b);
+            __m128i const vc = _mm_set1_epi8(c);
+            __m128i const vd = _mm_set1_epi8(d);
+            while (last - p >= 16)
+            {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+                __m128i hit = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)),
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, vc), _mm_cmpeq_epi8(chunk, vd)));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit)) ^ 0xffffu;
+                if (mask)
+                    return p + lowest_bit(mask);
+                p += 16;
+            }
+        #endif
+
+            for (; p != last; ++p)
+                if (*p != a && *p != b && *p != c && *p != d)
+                    return p;
+            return last;
+        }
+
+        //! Length of the escape sequence starting at \a p (which must be
+        //! ESC). CSI sequences end with a final byte in 0x40..0x7E, OSC and
+        //! other string sequences end with BEL or ST, anything else is a
+        //! two-byte escape. An unterminated sequence extends to \a last.
+        inline
+        size_t escape_length(char const* p, char const* last)
+        {
+            char const* q = p + 1;
+            if (q == last)
+                return 1;
+
+            if (*q == '[')
+            {
+                for (++q; q != last; ++q)
+                    if (*q >= 0x40 && *q <= 0x7e)
+                        return static_cast<size_t>(q + 1 - p);
+                return static_cast<size_t>(last - p);
+            }
+
+            if (*q == ']' || *q == 'P' || *q == '_' || *q == '^' || *q == 'X')
+            {
+                for (++q; q != last; ++q)
+                {
+                    if (*q == '\007')
+                        return static_cast<size_t>(q + 1 - p);
+                    if (*q == '\033' && q + 1 != last && q[1] == '\\')
+                        return static_cast<size_t>(q + 2 - p);
+                }
+                return static_cast<size_t>(last - p);
+            }
+
+            return 2;
+        }
+
+        //! Whether the escape of \a length bytes at \a p (as found by
+        //! `escape_length()`) is known to end there, rather than be cut by
+        //! the end of a chunk at \a last.
+        inline
+        bool escape_complete(char const* p, size_t length, char const* last)
+        {
+            if (p + length != last)
+                return true;
+            if (length < 2)
+                return false;
+            char c = p[length - 1];
+            if (p[1] == '[')
+                return length > 2 && c >= 0x40 && c <= 0x7e;
+            if (p[1] == ']' || p[1] == 'P' || p[1] == '_' || p[1] == '^' || p[1] == 'X')
+                return length > 2 && (c == '\007' || (c == '\\' && p[length - 2] == '\033'));
+            return length == 2;
+        }
+
+        //! Whether an escape sequence of \a length bytes at \a p is SGR,
+        //! i.e. "\033[...m" without private markers. Its parameters are
+        //! p[2]..p[length - 2].
+        inline
+        bool is_sgr(char const* p, size_t length)
+        {
+            return length >= 3 && p[1] == '[' && p[length - 1] == 'm'
+                && (length == 3 || p[2] < '<' || p[2] > '?');
+        }
+
+    } // namespace _internal
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_SCAN_HPP_
@@ -6,7 +6,9 @@
 //! objects that keep color/attribute info. User can create several such
 //! style-objects to quickly change current ostream state.
 //!
-//! "Style" is platform agnostic and depends only on "termcolor.hpp".
+//! "Style" is platform agnostic and depends only on "termcolor.hpp". The
+//! style class itself and its encoding live in "core.hpp"; this header
+//! adds the stream integration.
 //!
 //! Example.
 //!   style s, t;
@@ -22,161 +24,10 @@
 #define STYLE_HPP
 
 #include <termcolor/termcolor.hpp>
+#include <termcolor/core.hpp>
 
 namespace termcolor
 {
-    //! Style is a set of compatible attributes that can be applied
-    //! to the ostream updating current state.
-    class style
-    {
-        struct color_rgb_24bit
-        {
-            uint8_t foreground_red, foreground_green, foreground_blue;
-            uint8_t background_red, background_green, background_blue;
-            void clear()
-            {
-                foreground_red = foreground_green = foreground_blue = 0;
-                background_red = background_green = background_blue = 0;
-            }
-        };
-
-        struct color_index_8bit
-        {
-            uint8_t foreground;
-            uint8_t background;
-        };
-
-        struct color_named_4bit
-        {
-            uint8_t foreground;
-            uint8_t background;
-        };
-
-        union colors_tag
-        {
-            color_named_4bit    named;
-            color_index_8bit    index;
-            color_rgb_24bit     rgb;
-        };
-
-        enum color_type
-        {   color_type_none
-        ,   color_type_named
-        ,   color_type_indexed
-        ,   color_type_rgb
-        };
-
-        enum color_name
-        {   color_grey
-        ,   color_red
-        ,   color_green
-        ,   color_yellow
-        ,   color_blue
-        ,   color_magenta
-        ,   color_cyan
-        ,   color_white
-        };
-
-    private:
-        colors_tag  _colors;
-        uint16_t    _foreground_type: 2;
-        uint16_t    _background_type: 2;
-        uint16_t    _reset          : 1;
-        uint16_t    _bold           : 1;
-        uint16_t    _dark           : 1;
-        uint16_t    _underline      : 1;
-        uint16_t    _blink          : 1;
-        uint16_t    _reverse        : 1;
-        uint16_t    _concealed      : 1;
-        uint16_t    __reserved      : 5;
-
-    public:
-        style()
-        {
-            clear();
-        }
-
-        void clear()
-        {
-            _colors.rgb.clear();
-            _foreground_type = color_type_none;
-            _background_type = color_type_none;
-            _reset           = 1;
-            _bold            = 0;
-            _dark            = 0;
-            _underline       = 0;
-            _blink           = 0;
-            _reverse         = 0;
-            _concealed       = 0;
-            __reserved       = 0;
-        }
-
-#       if (__cplusplus >= 201100)
-        style( style const& ) = default;
-        style& operator= ( style const& ) = default;
-#       endif
-
-    friend std::ostream& operator<< (std::ostream& stream, style);
-
-    public:
-        style& reset    ( bool o = true ) { _reset     = o ? 1 : 0; return *this; }
-        style& bold     ( bool o = true ) { _bold      = o ? 1 : 0; return *this; }
-        style& dark     ( bool o = true ) { _dark      = o ? 1 : 0; return *this; }
-        style& underline( bool o = true ) { _underline = o ? 1 : 0; return *this; }
-        style& blink    ( bool o = true ) { _blink     = o ? 1 : 0; return *this; }
-        style& reverse  ( bool o = true ) { _reverse   = o ? 1 : 0; return *this; }
-        style& concealed( bool o = true ) { _concealed = o ? 1 : 0; return *this; }
-
-    public:
-        style& grey   () { _colors.named.foreground = color_grey    ; _foreground_type = color_type_named; return *this; }
-        style& red    () { _colors.named.foreground = color_red     ; _foreground_type = color_type_named; return *this; }
-        style& green  () { _colors.named.foreground = color_green   ; _foreground_type = color_type_named; return *this; }
-        style& yellow () { _colors.named.foreground = color_yellow  ; _foreground_type = color_type_named; return *this; }
-        style& blue   () { _colors.named.foreground = color_blue    ; _foreground_type = color_type_named; return *this; }
-        style& magenta() { _colors.named.foreground = color_magenta ; _foreground_type = color_type_named; return *this; }
-        style& cyan   () { _colors.named.foreground = color_cyan    ; _foreground_type = color_type_named; return *this; }
-        style& white  () { _colors.named.foreground = color_white   ; _foreground_type = color_type_named; return *this; }
-
-        style& on_grey   () { _colors.named.background = color_grey    ; _background_type = color_type_named; return *this; }
-        style& on_red    () { _colors.named.background = color_red     ; _background_type = color_type_named; return *this; }
-        style& on_green  () { _colors.named.background = color_green   ; _background_type = color_type_named; return *this; }
-        style& on_yellow () { _colors.named.background = color_yellow  ; _background_type = color_type_named; return *this; }
-        style& on_blue   () { _colors.named.background = color_blue    ; _background_type = color_type_named; return *this; }
-        style& on_magenta() { _colors.named.background = color_magenta ; _background_type = color_type_named; return *this; }
-        style& on_cyan   () { _colors.named.background = color_cyan    ; _background_type = color_type_named; return *this; }
-        style& on_white  () { _colors.named.background = color_white   ; _background_type = color_type_named; return *this; }
-
-        style& color   ( uint8_t i ) { _colors.index.foreground = i; _foreground_type = color_type_indexed; return *this; }
-        style& on_color( uint8_t i ) { _colors.index.background = i; _background_type = color_type_indexed; return *this; }
-
-        style& color( uint8_t red_, uint8_t green_, uint8_t blue_ )
-        {
-            _colors.rgb.foreground_red   = red_  ;
-            _colors.rgb.foreground_green = green_;
-            _colors.rgb.foreground_blue  = blue_ ;
-            _foreground_type = color_type_rgb;
-            return *this;
-        }
-
-        style& on_color( uint8_t red_, uint8_t green_, uint8_t blue_ )
-        {
-            _colors.rgb.background_red   = red_  ;
-            _colors.rgb.background_green = green_;
-            _colors.rgb.background_blue  = blue_ ;
-            _background_type = color_type_rgb;
-            return *this;
-        }
-
-        style& operator<< (const style& rhs)
-        {
-            return (*this = rhs);
-        }
-    };
-
-    #if (__cplusplus >= 201100)
-    static_assert( sizeof(style) == 8, "expected 8 bytes size" );
-    #endif
-
     inline
     std::ostream& operator<< (std::ostream& stream, style style_)
     {
@@ -285,28 +136,6 @@ namespace termcolor
         return st;
     }
 
-    //! Example: st << color(200) << on_color(100);
-    inline
-    style& operator<< (style& st, __color_index_8bit color)
-    {
-        color.foreground
-            ? st.color   ( color.index )
-            : st.on_color( color.index )
-            ;
-        return st;
-    }
-
-    //! Example: st << color(0,100,100) << on_color(50,0,0);
-    inline
-    style& operator<< (style& st, __color_rgb_24bit rgb)
-    {
-        rgb.foreground
-            ? st.color   ( rgb.red, rgb.green, rgb.blue )
-            : st.on_color( rgb.red, rgb.green, rgb.blue )
-            ;
-        return st;
-    }
-
     //! Remove some modifiers. Note that you can't "remove" a color.
     inline
     style& operator>> (style& st, std::ostream& (*fun)(std::ostream&))
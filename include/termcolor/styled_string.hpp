@@ -0,0 +1,305 @@
+//!
+//! styled_string
+//! ~~~~~~~~~~~~~
+//!
+//! "Styled string" extends termcolor library by adding a string type that
+//! keeps its styles apart from its text, i.e. the text contiguously and
+//! next to it an array of runs, each one a length and a `style`.
+//!
+//! Colored messages passed around as raw ANSI have to be parsed again to
+//! be measured, sliced or restyled. A styled string is parsed once (or
+//! built from styled pieces); slicing, concatenation and restyling work on
+//! the runs, and the display width is kept up to date as pieces are
+//! appended, so none of them looks at escapes. A run is 12 bytes (the
+//! 8-byte `style` and a 32-bit length), and adjacent runs of the same
+//! style are always merged. Escapes are only written when the string is
+//! rendered, as minimal transitions between runs.
+//!
+//! Example.
+//!   styled_string s("error", style().red().bold());
+//!   s.append(": file not found");
+//!   s.width();                          // 21
+//!   s.substr(0, 5).restyle(0, 1, style().red().bold().underline());
+//!   std::cout << s;
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_STYLED_STRING_HPP_
+#define TERMCOLOR_STYLED_STRING_HPP_
+
+#include <termcolor/termcolor.hpp>
+#include <termcolor/scan.hpp>
+#include <termcolor/width.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace termcolor
+{
+    class styled_string
+    {
+    public:
+        struct run
+        {
+            uint32_t    length;
+            style       s;
+        };
+
+        static size_t const npos = size_t(-1);
+
+        styled_string()
+            : _width(0)
+        {
+        }
+
+        //! \a text shouldn't have SGR escapes; see `parse()` for those.
+        explicit styled_string(std::string const& text, style const& s = style())
+            : _width(0)
+        {
+            append(text, s);
+        }
+
+        //! Build from raw ANSI output: SGR sequences become runs, other
+        //! escapes are kept in the text as they are.
+        static styled_string parse(char const* ansi, size_t size)
+        {
+            styled_string out;
+            style current;
+            char const* last = ansi + size;
+            while (ansi != last)
+            {
+                char const* esc = static_cast<char const*>(std::memchr(ansi, '\033', static_cast<size_t>(last - ansi)));
+                if (!esc)
+                    esc = last;
+                out.append(ansi, static_cast<size_t>(esc - ansi), current);
+                if (esc == last)
+                    break;
+
+                size_t length = _internal::escape_length(esc, last);
+                if (_internal::is_sgr(esc, length))
+                    current.apply(esc + 2, length - 3);
+                else
+                    out.append(esc, length, current);
+                ansi = esc + length;
+            }
+            return out;
+        }
+
+        static styled_string parse(std::string const& ansi)
+        {
+            return parse(ansi.data(), ansi.size());
+        }
+
+        styled_string& append(char const* text, size_t size, style const& s = style())
+        {
+            if (!size)
+                return *this;
+            _text.append(text, size);
+            _width += display_width(text, size);
+            push(_runs, s, size);
+            return *this;
+        }
+
+        styled_string& append(std::string const& text, style const& s = style())
+        {
+            return append(text.data(), text.size(), s);
+        }
+
+        //! Concatenation; the runs at the seam are merged if they match.
+        styled_string& append(styled_string const& other)
+        {
+            _text += other._text;
+            _width += other._width;
+            for (size_t i = 0; i < other._runs.size(); ++i)
+                push(_runs, other._runs[i].s, other._runs[i].length);
+            return *this;
+        }
+
+        styled_string& operator+= (styled_string const& other)
+        {
+            return append(other);
+        }
+
+        //! Bytes [\a pos, \a pos + \a count) with their styles. Offsets
+        //! are in bytes of the text, like for `std::string`, and should
+        //! fall on code point boundaries.
+        styled_string substr(size_t pos, size_t count = npos) const
+        {
+            styled_string out;
+            if (pos >= _text.size())
+                return out;
+            if (count > _text.size() - pos)
+                count = _text.size() - pos;
+
+            out._text.assign(_text, pos, count);
+            out._width = display_width(out._text);
+
+            size_t at = 0, end = pos + count;
+            for (size_t i = 0; i < _runs.size() && at < end; ++i)
+            {
+                size_t first = at, last = at + _runs[i].length;
+                at = last;
+                if (last <= pos)
+                    continue;
+                size_t from = first > pos ? first : pos, to = last < end ? last : end;
+                push(out._runs, _runs[i].s, to - from);
+            }
+            return out;
+        }
+
+        //! Give bytes [\a pos, \a pos + \a count) the style \a s.
+        styled_string& restyle(size_t pos, size_t count, style const& s)
+        {
+            if (pos >= _text.size())
+                return *this;
+            if (count > _text.size() - pos)
+                count = _text.size() - pos;
+
+            std::vector<run> runs;
+            runs.reserve(_runs.size() + 2);
+            size_t at = 0, end = pos + count;
+            for (size_t i = 0; i < _runs.size(); ++i)
+            {
+                size_t first = at, last = at + _runs[i].length;
+                at = last;
+                if (first < pos)
+                    push(runs, _runs[i].s, (last < pos ? last : pos) - first);
+                if (first <= pos && pos < last)
+                    push(runs, s, count);
+                if (last > end)
+                    push(runs, _runs[i].s, last - (first > end ? first : end));
+            }
+            _runs.swap(runs);
+            return *this;
+        }
+
+        //! Style of the byte at \a pos.
+        style style_at(size_t pos) const
+        {
+            for (size_t i = 0, at = 0; i < _runs.size(); ++i)
+            {
+                at += _runs[i].length;
+                if (pos < at)
+                    return _runs[i].s;
+            }
+            return style();
+        }
+
+        std::string const&      text()  const { return _text; }
+        std::vector<run> const& runs()  const { return _runs; }
+        size_t                  size()  const { return _text.size(); }
+        bool                    empty() const { return _text.empty(); }
+
+        //! Number of terminal columns the text takes, see `display_width()`.
+        size_t width() const { return _width; }
+
+        void clear()
+        {
+            _text.clear();
+            _runs.clear();
+            _width = 0;
+        }
+
+        //! Append the text with the escapes of its runs to \a out, starting
+        //! from and returning to the default state. Without colors only the
+        //! text is appended.
+        void render(std::string& out, bool colors = true) const
+        {
+            if (!colors)
+            {
+                out += _text;
+                return;
+            }
+
+            style shown;
+            size_t at = 0;
+            for (size_t i = 0; i < _runs.size(); ++i)
+            {
+                append_transition(out, shown, _runs[i].s);
+                shown = _runs[i].s;
+                out.append(_text, at, _runs[i].length);
+                at += _runs[i].length;
+            }
+            append_transition(out, shown, style());
+        }
+
+        std::string str(bool colors = true) const
+        {
+            std::string out;
+            render(out, colors);
+            return out;
+        }
+
+        friend bool operator== (styled_string const& lhs, styled_string const& rhs)
+        {
+            if (lhs._text != rhs._text || lhs._runs.size() != rhs._runs.size())
+                return false;
+            for (size_t i = 0; i < lhs._runs.size(); ++i)
+                if (lhs._runs[i].length != rhs._runs[i].length || lhs._runs[i].s != rhs._runs[i].s)
+                    return false;
+            return true;
+        }
+
+        friend bool operator!= (styled_string const& lhs, styled_string const& rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        //! Add \a length bytes in \a s, merged into the last run if it has
+        //! the same style.
+        static void push(std::vector<run>& runs, style const& s, size_t length)
+        {
+            uint32_t const max = 0xffffffffu;
+            while (length)
+            {
+                if (runs.empty() || !(runs.back().s == s) || runs.back().length == max)
+                {
+                    run r = { 0, s };
+                    runs.push_back(r);
+                }
+                size_t room = max - runs.back().length;
+                size_t part = length < room ? length : room;
+                runs.back().length += static_cast<uint32_t>(part);
+                length -= part;
+            }
+        }
+
+        //! `append(out, from, to)` under another name, since `append` is
+        //! a member here.
+        static void append_transition(std::string& out, style const& from, style const& to)
+        {
+            termcolor::append(out, from, to);
+        }
+
+    private:
+        std::string         _text;
+        std::vector<run>    _runs;
+        size_t              _width;
+    };
+
+    #if (__cplusplus >= 201100)
+    static_assert( sizeof(styled_string::run) == 12, "expected 12 bytes runs" );
+    #endif
+
+    inline
+    styled_string operator+ (styled_string lhs, styled_string const& rhs)
+    {
+        return lhs.append(rhs);
+    }
+
+    //! Print with minimal escapes. Colors follow the stream's colorize
+    //! state, as for the manipulators.
+    inline
+    std::ostream& operator<< (std::ostream& stream, styled_string const& s)
+    {
+        std::string out;
+        s.render(out, _internal::is_colorized(stream));
+        return stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+    }
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_STYLED_STRING_HPP_
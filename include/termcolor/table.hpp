@@ -0,0 +1,361 @@
+//!
+//! table
+//! ~~~~~
+//!
+//! "Table" extends termcolor library by adding a table renderer, i.e. an
+//! object that collects rows of styled cells and prints them with aligned
+//! columns.
+//!
+//! Every cell is measured once, when it's added: its display width
+//! (escapes and control characters take no space, so tabs should be
+//! expanded first; wide characters take two columns) is kept with it and
+//! the widths of the columns are updated in the same pass, so rendering
+//! doesn't measure anything again. Cell texts are kept in one
+//! buffer rather than a string each. Cells wider than their column's limit
+//! are cut and end with an ellipsis. Rows are written with style deltas
+//! only: nothing is emitted between cells of the same style, padding
+//! keeps the current style where spaces look the same in it, and the
+//! transitions between the styles in use are computed once per render.
+//!
+//! Example.
+//!   table t;
+//!   t.align(2, table::right).max_width(0, 24);
+//!   t.row().cell("test", style().bold()).cell("result", style().bold()).cell("ms", style().bold());
+//!   t.row().cell(name).cell("PASS", style().green()).cell("12");
+//!   t.render(std::cout);
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_TABLE_HPP_
+#define TERMCOLOR_TABLE_HPP_
+
+#include <termcolor/termcolor.hpp>
+#include <termcolor/width.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace termcolor
+{
+    class table
+    {
+        struct cell_info
+        {
+            style       s;
+            size_t      offset;
+            uint32_t    length;
+            uint32_t    width;
+            uint16_t    style_id;       // `uncached` if not interned
+            bool        escapes;        // the text has escapes of its own
+        };
+
+        static uint16_t const uncached = 0xffff;
+
+        //! Transitions are cached for this many distinct styles at most.
+        static size_t const max_styles = 64;
+
+    public:
+        enum alignment
+        {   left
+        ,   right
+        };
+
+        table()
+            : _separator("  ")
+            , _ellipsis("\xe2\x80\xa6")
+        {
+            _styles.push_back(style());
+        }
+
+        //! Start a new row. Rows may have fewer cells than others.
+        table& row()
+        {
+            _rows.push_back(_cells.size());
+            return *this;
+        }
+
+        //! Add a cell to the current row. \a text may have escapes of its
+        //! own; the terminal is reset after such cells.
+        table& cell(char const* text, size_t length, style const& s = style())
+        {
+            if (_rows.empty())
+                row();
+
+            size_t column = _cells.size() - _rows.back();
+            cell_info c;
+            c.s        = s;
+            c.offset   = _text.size();
+            c.length   = static_cast<uint32_t>(length);
+            c.width    = static_cast<uint32_t>(display_width(text, length));
+            c.style_id = intern(s);
+            c.escapes  = std::memchr(text, '\033', length) != 0;
+            _text.append(text, length);
+            _cells.push_back(c);
+
+            if (_widths.size() <= column)
+                _widths.resize(column + 1, 0);
+            if (_widths[column] < c.width)
+                _widths[column] = c.width;
+            return *this;
+        }
+
+        table& cell(std::string const& text, style const& s = style())
+        {
+            return cell(text.data(), text.size(), s);
+        }
+
+        table& align(size_t column, alignment a)
+        {
+            if (_alignments.size() <= column)
+                _alignments.resize(column + 1, left);
+            _alignments[column] = a;
+            return *this;
+        }
+
+        //! Cells wider than \a width columns are cut, ending with the
+        //! ellipsis.
+        table& max_width(size_t column, size_t width)
+        {
+            if (_limits.size() <= column)
+                _limits.resize(column + 1, size_t(-1));
+            _limits[column] = width;
+            return *this;
+        }
+
+        //! Text between columns, "  " by default.
+        table& separator(std::string const& text, style const& s = style())
+        {
+            _separator = text;
+            _separator_style = s;
+            return *this;
+        }
+
+        table& ellipsis(std::string const& text)
+        {
+            _ellipsis = text;
+            return *this;
+        }
+
+        size_t rows() const { return _rows.size(); }
+
+        //! Width of \a column as rendered, limit included.
+        size_t column_width(size_t column) const
+        {
+            if (column >= _widths.size())
+                return 0;
+            size_t limit = column < _limits.size() ? _limits[column] : size_t(-1);
+            return _widths[column] < limit ? _widths[column] : limit;
+        }
+
+        void clear()
+        {
+            _text.clear();
+            _cells.clear();
+            _rows.clear();
+            _widths.clear();
+            _styles.assign(1, style());
+        }
+
+        //! Append the table to \a out, a line per row. Every line ends in
+        //! the default state. Without colors no escapes are added (those
+        //! in the cell texts are kept).
+        void render(std::string& out, bool colors = true) const
+        {
+            renderer r(*this, out, colors);
+            for (size_t i = 0; i < _rows.size(); ++i)
+                r.line(_rows[i], i + 1 < _rows.size() ? _rows[i + 1] : _cells.size());
+        }
+
+        //! Print the table to \a stream. Colors follow the stream's
+        //! colorize state, as for the manipulators.
+        void render(std::ostream& stream) const
+        {
+            std::string out;
+            render(out, _internal::is_colorized(stream));
+            stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+        }
+
+    private:
+        uint16_t intern(style const& s)
+        {
+            for (size_t id = 0; id < _styles.size(); ++id)
+                if (_styles[id] == s)
+                    return static_cast<uint16_t>(id);
+            if (_styles.size() == max_styles)
+                return uncached;
+            _styles.push_back(s);
+            return static_cast<uint16_t>(_styles.size() - 1);
+        }
+
+        //! Whether spaces look the same in \a s as in the default state,
+        //! i.e. it only changes the foreground, weight, blinking or
+        //! visibility of glyphs.
+        static bool blank_neutral(style const& s)
+        {
+            static char const glyph_only[] = "39;22;25;28";
+            style blank = s;
+            blank.apply(glyph_only, sizeof(glyph_only) - 1);
+            return blank == style();
+        }
+
+        class renderer
+        {
+        public:
+            renderer(table const& t, std::string& out, bool colors)
+                : _table(t)
+                , _out(out)
+                , _colors(colors)
+                , _shown(t._styles[0])
+                , _shown_id(0)
+                , _transitions(t._styles.size() * t._styles.size())
+                , _neutral(t._styles.size())
+                , _separator_id(uncached)
+                , _separator_blank(t._separator.find_first_not_of(' ') == std::string::npos &&
+                                   blank_neutral(t._separator_style))
+                , _separator_width(display_width(t._separator))
+            {
+                for (size_t id = 0; id < t._styles.size(); ++id)
+                {
+                    _neutral[id] = blank_neutral(t._styles[id]);
+                    if (t._styles[id] == t._separator_style && _separator_id == uncached)
+                        _separator_id = static_cast<uint16_t>(id);
+                }
+
+                size_t columns = t._widths.size(), line = 0;
+                for (size_t c = 0; c < columns; ++c)
+                {
+                    _widths.push_back(t.column_width(c));
+                    line += _widths.back() + _separator_width;
+                }
+                _out.reserve(_out.size() + t._text.size() + t._rows.size() * (line + 1) +
+                             (colors ? t._cells.size() * 4 : 0));
+            }
+
+            //! Cells [first, last) as one line.
+            void line(size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; ++i)
+                {
+                    size_t column = i - first;
+                    if (column)
+                    {
+                        if (!_separator_blank || !neutral_shown())
+                            switch_to(_table._separator_style, _separator_id);
+                        _out += _table._separator;
+                    }
+
+                    cell_info const& c = _table._cells[i];
+                    size_t width = _widths[column];
+                    bool cut = c.width > width;
+                    size_t padding = cut ? 0 : width - c.width;
+                    bool to_right = column < _table._alignments.size() && _table._alignments[column] == right;
+
+                    if (to_right && padding)
+                        pad(padding, c.style_id);
+
+                    switch_to(c.s, c.style_id);
+                    char const* text = _table._text.data() + c.offset;
+                    if (cut)
+                        text_cut(text, c.length, width);
+                    else
+                        _out.append(text, c.length);
+                    if (c.escapes && _colors)
+                    {
+                        // The cell changed the state behind our back.
+                        _out += "\033[0m";
+                        _shown = style();
+                        _shown_id = 0;
+                    }
+
+                    // No trailing spaces at the end of a line.
+                    if (!to_right && padding && i + 1 < last)
+                        pad(padding, _separator_blank ? uncached : _separator_id);
+                }
+                switch_to(style(), 0);
+                _out += '\n';
+            }
+
+        private:
+            bool neutral_shown() const
+            {
+                return _shown_id != uncached ? _neutral[_shown_id] : blank_neutral(_shown);
+            }
+
+            //! Spaces in the current style if they look the same as in
+            //! the default one (saving two transitions), else in the
+            //! default style or in the style that comes next.
+            void pad(size_t count, uint16_t next_id)
+            {
+                if (!neutral_shown())
+                {
+                    // Switching to the next cell's style early is as good
+                    // as the default if spaces look the same in it.
+                    if (next_id != uncached && _neutral[next_id])
+                        switch_to(_table._styles[next_id], next_id);
+                    else
+                        switch_to(style(), 0);
+                }
+                _out.append(count, ' ');
+            }
+
+            void switch_to(style const& s, uint16_t id)
+            {
+                if (!_colors)
+                    return;
+                if (id != uncached && id == _shown_id)
+                    return;
+
+                if (id != uncached && _shown_id != uncached)
+                {
+                    std::string& t = _transitions[_shown_id * _table._styles.size() + id];
+                    if (t.empty())
+                        append(t, _shown, s);
+                    _out += t;
+                }
+                else
+                    append(_out, _shown, s);
+                _shown = s;
+                _shown_id = id;
+            }
+
+            void text_cut(char const* text, size_t length, size_t width)
+            {
+                std::string cut = truncate(text, length, width, _table._ellipsis);
+                _out += cut;
+                size_t used = display_width(cut);
+                if (used < width)
+                    _out.append(width - used, ' ');
+            }
+
+        private:
+            table const&                _table;
+            std::string&                _out;
+            bool                        _colors;
+            style                       _shown;
+            uint16_t                    _shown_id;
+            std::vector<std::string>    _transitions;
+            std::vector<bool>           _neutral;
+            uint16_t                    _separator_id;
+            bool                        _separator_blank;
+            size_t                      _separator_width;
+            std::vector<size_t>         _widths;
+        };
+
+    private:
+        std::string                             _text;
+        std::vector<cell_info>                  _cells;
+        std::vector<size_t>                     _rows;          // first cell of each row
+        std::vector<size_t>                     _widths;        // widest cell of each column
+        std::vector<size_t>                     _limits;
+        std::vector<alignment>                  _alignments;
+        std::vector<style>                      _styles;        // interned, 0 is the default
+        std::string                             _separator;
+        style                                   _separator_style;
+        std::string                             _ellipsis;
+    };
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_TABLE_HPP_
@@ -44,10 +44,8 @@
 #include <iostream>
 #include <cstdio>
 
-// 8/24-bit coloring exploits the "uint8_t" type i.e. "unsigned char". For
-// backward compatibility with pre-C++11 compilers it's better to use <stdint.h>
-// and global uint8_t than C++11's <cstdint> and scoped std::uint8_t.
-#include <stdint.h>
+// Colors, styles and their encoding don't depend on streams.
+#include <termcolor/core.hpp>
 
 
 namespace termcolor
@@ -57,12 +55,20 @@ namespace termcolor
     namespace _internal
     {
         // An index to be used to access a private storage of I/O streams. See
-        // colorize / nocolorize I/O manipulators for details.
-        static int colorize_index = std::ios_base::xalloc();
+        // colorize / nocolorize I/O manipulators for details. It's allocated
+        // on first use and shared by the whole program, rather than taken by
+        // a static initializer in every translation unit. Bit 0 is the
+        // colorize flag, bits 1-2 the `color_depth` set with `max_colors()`.
+        inline int colorize_index()
+        {
+            static int const index = std::ios_base::xalloc();
+            return index;
+        }
 
         inline FILE* get_standard_stream(const std::ostream& stream);
         inline bool is_colorized(std::ostream& stream);
         inline bool is_atty(const std::ostream& stream);
+        inline color_depth max_colors(std::ostream& stream);
 
     #if defined(TERMCOLOR_OS_WINDOWS)
         inline void win_change_attributes(std::ostream& stream, int foreground, int background=-1);
@@ -72,14 +78,14 @@ namespace termcolor
     inline
     std::ostream& colorize(std::ostream& stream)
     {
-        stream.iword(_internal::colorize_index) = 1L;
+        stream.iword(_internal::colorize_index()) |= 1L;
         return stream;
     }
 
     inline
     std::ostream& nocolorize(std::ostream& stream)
     {
-        stream.iword(_internal::colorize_index) = 0L;
+        stream.iword(_internal::colorize_index()) &= ~1L;
         return stream;
     }
 
@@ -443,18 +449,6 @@ namespace termcolor
 
 
 
-    struct __color_index_8bit
-    {
-        uint8_t index;
-        bool foreground;
-    };
-
-    struct __color_rgb_24bit
-    {
-        uint8_t red, green, blue;
-        bool foreground;
-    };
-
     namespace _internal
     {
         #if defined(TERMCOLOR_OS_MACOS) || defined(TERMCOLOR_OS_LINUX)
@@ -462,16 +456,42 @@ namespace termcolor
         {
             char buffer[24];
 
-            ansi_color(__color_index_8bit color)
+            ansi_color(__color_index_8bit color, color_depth depth = colors_unknown)
+            {
+                if (depth == colors_16 && color.index >= 16)
+                {
+                    uint32_t rgb = palette_color(color.index);
+                    color.index = nearest_basic_index(
+                        static_cast<uint8_t>(rgb >> 16), static_cast<uint8_t>(rgb >> 8), static_cast<uint8_t>(rgb));
+                }
+
+                if (depth == colors_16)
+                    basic(color.index, color.foreground);
+                else
+                    ::sprintf(buffer, "\033[" "%c" "8;5;" "%im",
+                        (color.foreground ? '3':'4'), color.index);
+            }
+
+            ansi_color(__color_rgb_24bit rgb, color_depth depth = colors_unknown)
             {
-                ::sprintf(buffer, "\033[" "%c" "8;5;" "%im",
-                    (color.foreground ? '3':'4'), color.index);
+                if (depth == colors_16)
+                    basic(nearest_basic_index(rgb.red, rgb.green, rgb.blue), rgb.foreground);
+                else if (depth == colors_256)
+                    ::sprintf(buffer, "\033[" "%c" "8;5;" "%im",
+                        (rgb.foreground ? '3':'4'), nearest_color_index(rgb.red, rgb.green, rgb.blue));
+                else
+                    ::sprintf(buffer, "\033[" "%c" "8;2;" "%i;" "%i;" "%im",
+                        (rgb.foreground ? '3':'4'), rgb.red, rgb.green, rgb.blue);
             }
 
-            ansi_color(__color_rgb_24bit rgb)
+            //! "3x" / "4x" for the first 8 colors, "9x" / "10x" for the
+            //! bright ones.
+            void basic(uint8_t index, bool foreground)
             {
-                ::sprintf(buffer, "\033[" "%c" "8;2;" "%i;" "%i;" "%im",
-                    (rgb.foreground ? '3':'4'), rgb.red, rgb.green, rgb.blue);
+                if (index < 8)
+                    ::sprintf(buffer, "\033[%c%im", (foreground ? '3':'4'), index);
+                else
+                    ::sprintf(buffer, "\033[%s%im", (foreground ? "9":"10"), index - 8);
             }
 
             operator const char* () const { return buffer; }
@@ -482,37 +502,13 @@ namespace termcolor
 
     } // namespace _internal
 
-    inline
-    __color_index_8bit color(uint8_t index)
-    {
-        return { index, /* .foreground = */ true };
-    }
-
-    inline
-    __color_rgb_24bit color(uint8_t red, uint8_t green, uint8_t blue)
-    {
-        return { red, green, blue, /* .foreground = */ true };
-    }
-
-    inline
-    __color_index_8bit on_color(uint8_t index)
-    {
-        return { index, /* .foregound = */ false };
-    }
-
-    inline
-    __color_rgb_24bit on_color(uint8_t red, uint8_t green, uint8_t blue)
-    {
-        return { red, green, blue, /* .foreground = */ false };
-    }
-
     inline
     std::ostream& operator<< (std::ostream& stream, __color_index_8bit color)
     {
         if (_internal::is_colorized(stream))
         {
         #if defined(TERMCOLOR_OS_MACOS) || defined(TERMCOLOR_OS_LINUX)
-            stream << _internal::ansi_color(color);
+            stream << _internal::ansi_color(color, _internal::max_colors(stream));
         #elif defined(TERMCOLOR_OS_WINDOWS)
             // TODO: implement 8-bit indexed color support for Windows terminal.
         #endif
@@ -526,7 +522,7 @@ namespace termcolor
         if (_internal::is_colorized(stream))
         {
         #if defined(TERMCOLOR_OS_MACOS) || defined(TERMCOLOR_OS_LINUX)
-            stream << _internal::ansi_color(color);
+            stream << _internal::ansi_color(color, _internal::max_colors(stream));
         #elif defined(TERMCOLOR_OS_WINDOWS)
             // TODO: implement 24-bit RGB color support for Windows terminal
         #endif
@@ -534,6 +530,29 @@ namespace termcolor
         return stream;
     }
 
+    struct __color_depth_limit
+    {
+        color_depth depth;
+    };
+
+    //! Write 8-bit and 24-bit colors to the stream with at most \a depth,
+    //! e.g. as found by `probe_terminal()` (see "probe.hpp").
+    //! Example: std::cout << max_colors(colors_256) << color(255, 128, 0);
+    inline
+    __color_depth_limit max_colors(color_depth depth)
+    {
+        __color_depth_limit limit = { depth };
+        return limit;
+    }
+
+    inline
+    std::ostream& operator<< (std::ostream& stream, __color_depth_limit limit)
+    {
+        long& flags = stream.iword(_internal::colorize_index());
+        flags = (flags & ~6L) | (static_cast<long>(limit.depth) << 1);
+        return stream;
+    }
+
 
     //! Since C++ hasn't a way to hide something in the header from
     //! the outer access, I have to introduce this namespace which
@@ -561,7 +580,14 @@ namespace termcolor
         inline
         bool is_colorized(std::ostream& stream)
         {
-            return is_atty(stream) || static_cast<bool>(stream.iword(colorize_index));
+            return is_atty(stream) || static_cast<bool>(stream.iword(colorize_index()) & 1L);
+        }
+
+        //! The limit set on a stream with `max_colors()`.
+        inline
+        color_depth max_colors(std::ostream& stream)
+        {
+            return static_cast<color_depth>(stream.iword(colorize_index()) >> 1 & 3L);
         }
 
         //! Test whether a given `std::ostream` object refers to
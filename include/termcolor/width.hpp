@@ -0,0 +1,347 @@
+//!
+//! width
+//! ~~~~~
+//!
+//! "Width" extends termcolor library by adding an escape-aware display
+//! width and wrapping engine, i.e. functions that measure, wrap and
+//! truncate UTF-8 strings containing termcolor escape sequences by the
+//! number of terminal columns they occupy.
+//!
+//! Escape sequences are skipped in place, without stripping them into a
+//! temporary. Runs of printable ASCII are measured 16 bytes at a time and
+//! other code points are looked up in a compact two-level table of East
+//! Asian wide and zero-width characters, generated ahead of time (see
+//! "width_table.hpp"), so nothing is built at run time. Control
+//! characters, tab included, take no columns.
+//!
+//! Example.
+//!   std::string s;
+//!   append(s, style().red());
+//!   s += "日本語";
+//!   display_width(s);                 // 6
+//!   wrap(s, 4);                       // { "\033[0;31m日本\033[0m",
+//!                                     //   "\033[31m語\033[0m" }
+//!
+//! :copyright: (c) 2017 by Alexey Mission
+//! :license: BSD, see LICENSE for details
+
+#ifndef TERMCOLOR_WIDTH_HPP_
+#define TERMCOLOR_WIDTH_HPP_
+
+#include <termcolor/core.hpp>
+#include <termcolor/scan.hpp>
+#include <termcolor/width_table.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace termcolor
+{
+    namespace _internal
+    {
+        //! Columns of a code point, from the two-level table generated
+        //! into "width_table.hpp" (see tools/width_table.cpp).
+        inline
+        int codepoint_columns(uint32_t cp)
+        {
+            if (cp >= 0x110000)
+                return 1;
+            uint8_t bits = width_stage2()[width_stage1()[cp >> 8] * 64u + ((cp & 0xff) >> 2)];
+            switch ((bits >> ((cp & 3) * 2)) & 3)
+            {
+                case 1:  return 0;
+                case 2:  return 2;
+                default: return 1;
+            }
+        }
+
+        //! Decode one UTF-8 sequence at \a p. Malformed input is consumed one
+        //! byte at a time and reported as U+FFFD.
+        inline
+        uint32_t decode_utf8(char const*& p, char const* last)
+        {
+            unsigned char lead = static_cast<unsigned char>(*p++);
+            if (lead < 0x80)
+                return lead;
+
+            size_t extra;
+            uint32_t cp;
+            if      ((lead & 0xe0) == 0xc0) { extra = 1; cp = lead & 0x1f; }
+            else if ((lead & 0xf0) == 0xe0) { extra = 2; cp = lead & 0x0f; }
+            else if ((lead & 0xf8) == 0xf0) { extra = 3; cp = lead & 0x07; }
+            else return 0xfffd;
+
+            if (static_cast<size_t>(last - p) < extra)
+                return 0xfffd;
+            for (size_t i = 0; i < extra; ++i)
+                if ((static_cast<unsigned char>(p[i]) & 0xc0) != 0x80)
+                    return 0xfffd;
+
+            for (size_t i = 0; i < extra; ++i)
+                cp = (cp << 6) | (static_cast<unsigned char>(*p++) & 0x3f);
+            return cp;
+        }
+
+        //! Shared walker of the measuring/wrapping functions: calls
+        //! `on_text(first, last, width)` for runs of visible text that can't
+        //! be split further and `on_escape(first, length)` for escape
+        //! sequences. Printable ASCII runs are reported in one call with
+        //! `width == length`.
+        template <typename Text, typename Escape>
+        void walk(char const* p, char const* last, Text on_text, Escape on_escape)
+        {
+            while (p != last)
+            {
+                size_t run = printable_ascii_run(p, last);
+                if (run)
+                {
+                    if (!on_text(p, p + run, run))
+                        return;
+                    p += run;
+                    continue;
+                }
+
+                if (*p == '\033')
+                {
+                    size_t length = escape_length(p, last);
+                    on_escape(p, length);
+                    p += length;
+                    continue;
+                }
+
+                char const* start = p;
+                uint32_t cp = decode_utf8(p, last);
+                if (!on_text(start, p, static_cast<size_t>(codepoint_columns(cp))))
+                    return;
+            }
+        }
+
+        struct ignore_escape
+        {
+            void operator() (char const*, size_t) const {}
+        };
+
+        struct sum_width
+        {
+            size_t* total;
+            bool operator() (char const*, char const*, size_t width) const
+            {
+                *total += width;
+                return true;
+            }
+        };
+
+        struct track_style
+        {
+            style* state;
+            std::string* out;
+            void operator() (char const* p, size_t length) const
+            {
+                if (is_sgr(p, length))
+                    state->apply(p + 2, length - 3);
+                out->append(p, length);
+            }
+        };
+    } // namespace _internal
+
+    //! Number of columns a code point occupies: 0, 1 or 2. Control
+    //! characters, tab included, count as 0 since how far they move the
+    //! cursor depends on where it is; expand tabs before measuring.
+    inline
+    int codepoint_width(uint32_t cp)
+    {
+        return _internal::codepoint_columns(cp);
+    }
+
+    //! Number of columns the UTF-8 \a text occupies on the terminal.
+    //! Escape sequences and control characters (tab too, see
+    //! `codepoint_width`) take no space.
+    inline
+    size_t display_width(char const* text, size_t length)
+    {
+        size_t total = 0;
+        _internal::sum_width sum = { &total };
+        _internal::walk(text, text + length, sum, _internal::ignore_escape());
+        return total;
+    }
+
+    inline
+    size_t display_width(std::string const& text)
+    {
+        return display_width(text.data(), text.size());
+    }
+
+    namespace _internal
+    {
+        class wrapper
+        {
+            std::vector<std::string>& _lines;
+            size_t                    _columns;
+            std::string               _line;
+            size_t                    _used;
+            style                     _active;
+
+        public:
+            wrapper(std::vector<std::string>& lines, size_t columns)
+                : _lines(lines), _columns(columns ? columns : 1), _used(0)
+            {}
+
+            bool operator() (char const* first, char const* last, size_t width)
+            {
+                // Hard line breaks of the input are kept as is.
+                if (width == 0 && *first == '\n')
+                {
+                    finish();
+                    return true;
+                }
+
+                // ASCII runs are copied by whole chunks that fit.
+                if (width == static_cast<size_t>(last - first) && width > 1)
+                {
+                    while (first != last)
+                    {
+                        if (_used == _columns)
+                            finish();
+                        size_t chunk = std::min(static_cast<size_t>(last - first), _columns - _used);
+                        _line.append(first, chunk);
+                        _used += chunk;
+                        first += chunk;
+                    }
+                    return true;
+                }
+
+                if (_used + width > _columns && _used > 0)
+                    finish();
+                _line.append(first, last);
+                _used += width;
+                return true;
+            }
+
+            std::string& line() { return _line; }
+            style& active() { return _active; }
+
+            //! Close the current line and re-open the active style on the
+            //! next one, so every line is styled on its own.
+            void finish()
+            {
+                append(_line, _active, style());
+                _lines.push_back(_line);
+                _line.clear();
+                append(_line, style(), _active);
+                _used = 0;
+            }
+
+            void done()
+            {
+                if (_used || _lines.empty())
+                {
+                    append(_line, _active, style());
+                    _lines.push_back(_line);
+                }
+            }
+        };
+
+        struct wrapper_ref
+        {
+            wrapper* w;
+            bool operator() (char const* first, char const* last, size_t width) const
+            {
+                return (*w)(first, last, width);
+            }
+        };
+    } // namespace _internal
+
+    //! Split \a text into lines of at most \a columns columns. Lines break
+    //! at the column limit and at the newlines of the input. Every line
+    //! ends in the default state and starts by re-opening the style that
+    //! was active at the break, so the lines can be printed independently.
+    inline
+    std::vector<std::string> wrap(char const* text, size_t length, size_t columns)
+    {
+        std::vector<std::string> lines;
+        _internal::wrapper w(lines, columns);
+        _internal::wrapper_ref ref = { &w };
+        _internal::track_style escape = { &w.active(), &w.line() };
+        _internal::walk(text, text + length, ref, escape);
+        w.done();
+        return lines;
+    }
+
+    inline
+    std::vector<std::string> wrap(std::string const& text, size_t columns)
+    {
+        return wrap(text.data(), text.size(), columns);
+    }
+
+    namespace _internal
+    {
+        struct truncator
+        {
+            std::string* out;
+            size_t       limit;
+            size_t       used;
+
+            bool operator() (char const* first, char const* last, size_t width)
+            {
+                if (width == static_cast<size_t>(last - first) && used + width > limit)
+                {
+                    out->append(first, limit - used);
+                    used = limit;
+                    return false;
+                }
+                if (used + width > limit)
+                    return false;
+                out->append(first, last);
+                used += width;
+                return true;
+            }
+        };
+
+        struct truncator_ref
+        {
+            truncator* t;
+            bool operator() (char const* first, char const* last, size_t width) const
+            {
+                return (*t)(first, last, width);
+            }
+        };
+    } // namespace _internal
+
+    //! Cut \a text down to \a columns columns. If anything is cut, the
+    //! \a ellipsis is appended (it counts into the columns). Escapes before
+    //! the cut are kept and the result is closed back to the default state.
+    inline
+    std::string truncate(char const* text, size_t length, size_t columns,
+                         std::string const& ellipsis = "\xe2\x80\xa6")
+    {
+        if (display_width(text, length) <= columns)
+            return std::string(text, length);
+
+        size_t ellipsis_width = display_width(ellipsis);
+        if (ellipsis_width > columns)
+            ellipsis_width = columns = 0;
+
+        std::string out;
+        style active;
+        _internal::truncator cut = { &out, columns - ellipsis_width, 0 };
+        _internal::truncator_ref ref = { &cut };
+        _internal::track_style escape = { &active, &out };
+        _internal::walk(text, text + length, ref, escape);
+
+        if (ellipsis_width)
+            out += ellipsis;
+        append(out, active, style());
+        return out;
+    }
+
+    inline
+    std::string truncate(std::string const& text, size_t columns,
+                         std::string const& ellipsis = "\xe2\x80\xa6")
+    {
+        return truncate(text.data(), text.size(), columns, ellipsis);
+    }
+
+} // namespace termcolor
+
+#endif // TERMCOLOR_WIDTH_HPP_
@@ -24,12 +24,34 @@
 #   undef __STRICT_ANSI__
 #   include <iostream>
 #   include <sstream>
+#   include <fstream>
 #   define __STRICT_ANSI__
 #else
 #   include <iostream>
 #   include <sstream>
+#   include <fstream>
 #endif
 #include "termcolor/termcolor.hpp"
+#include "termcolor/style.hpp"
+#include "termcolor/progress.hpp"
+#include "termcolor/width.hpp"
+#include "termcolor/diff.hpp"
+#include "termcolor/hexdump.hpp"
+#include "termcolor/json.hpp"
+#include "termcolor/logfmt.hpp"
+#include "termcolor/nonblocking.hpp"
+#include "termcolor/image.hpp"
+#include "termcolor/report.hpp"
+#include "termcolor/record.hpp"
+#include "termcolor/table.hpp"
+#include "termcolor/styled_string.hpp"
+#include "termcolor/minify.hpp"
+#include "termcolor/log_index.hpp"
+#include "termcolor/mux.hpp"
+
+#if defined(__linux__)
+#   include <sys/resource.h>
+#endif
 
 using namespace termcolor;
 
@@ -88,5 +110,532 @@ int main(int /*argc*/, char** /*argv*/)
     if (s2.str() != "\033[31m" "termcolor")
         return 2;
 
+    // test styles are appended as single merged sequences and transitions
+    // between styles carry only what has changed
+    std::string s3;
+    append(s3, style().red().bold());
+    append(s3, style().red().bold(), style().red());
+    append(s3, style().red(), style().color(1, 2, 3).on_blue());
+    append(s3, style().color(1, 2, 3).on_blue(), style().color(1, 2, 3).on_blue());
+    append(s3, style().color(1, 2, 3).on_blue(), style());
+
+    if (s3 != "\033[0;1;31m" "\033[22m" "\033[38;2;1;2;3;44m" "\033[0m")
+        return 3;
+
+    // test progress bars degrade to plain lines for non-tty streams
+    std::stringstream s4;
+    {
+        progress bars(s4);
+        bars.label_width(4);
+        size_t job = bars.add("job", 4);
+        bars.advance(job, 3);
+        bars.render();
+        bars.set(job, 4);
+    }
+
+    if (s4.str() != "job   75% (3/4)\n" "job  100% (4/4)\n")
+        return 4;
+
+    // test labels are cut by columns, not bytes, and huge totals don't
+    // overflow the percentage
+    std::stringstream s4_huge;
+    {
+        progress bars(s4_huge);
+        bars.label_width(5);
+        size_t job = bars.add("\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e", uint64_t(-1));
+        bars.set(job, uint64_t(-1) / 4 * 3);
+        bars.render();
+    }
+
+    if (s4_huge.str() != "\xe6\x97\xa5\xe6\x9c\xac   74% (13835058055282163709/18446744073709551615)\n")
+        return 4;
+
+    // test display width skips escapes and knows wide/zero-width characters,
+    // and wrapping re-opens the active style on every line
+    std::string s5 = "\033[31m" "ab\xe6\x97\xa5" "e\xcc\x81" "\033[0m";
+    std::vector<std::string> s5_lines = wrap(s5, 3);
+
+    if (display_width(s5) != 5 ||
+        s5_lines.size() != 2 ||
+        s5_lines[0] != "\033[31m" "ab" "\033[0m" ||
+        s5_lines[1] != "\033[31m" "\xe6\x97\xa5" "e\xcc\x81" "\033[0m" ||
+        truncate(s5, 4, ".") != "\033[31m" "ab" "." "\033[0m")
+        return 5;
+
+    // test the generated table: control characters, tab too, take no
+    // columns, and code points past Unicode take one
+    if (codepoint_width('\t') != 0 || codepoint_width(0x9b) != 0 || codepoint_width(0x301) != 0 ||
+        codepoint_width(0xac00) != 2 || codepoint_width(0x1f600) != 2 || codepoint_width(0x110000) != 1 ||
+        display_width("a\tb") != 2)
+        return 5;
+
+    // test diffs are rendered in unified format with changed words
+    // highlighted within the changed line pairs
+    std::string s6_plain, s6_colored;
+    diff().context(1).render(s6_plain, "a\nb\nc\nd\n", "a\nb\nC\nd\ne\n", false);
+    diff().context(0).render(s6_colored, "x y\n", "x z\n");
+
+    if (s6_plain != "@@ -2,3 +2,4 @@\n" " b\n" "-c\n" "+C\n" " d\n" "+e\n" ||
+        s6_colored != "\033[36m@@ -1,1 +1,1 @@\033[0m\n"
+                      "\033[31m-x \033[7my\033[0m\n"
+                      "\033[32m+x \033[7mz\033[0m\n")
+        return 6;
+
+    // test a missing line break at the end is a change, marked as diff(1)
+    // does, also when the line is kept as context
+    std::string s6_newline, s6_context;
+    bool s6_differ = diff().render(s6_newline, "x", "x\n", false);
+    diff().context(1).render(s6_context, "a\nb", "A\nb", false);
+
+    if (!s6_differ ||
+        s6_newline != "@@ -1,1 +1,1 @@\n" "-x\n" "\\ No newline at end of file\n" "+x\n" ||
+        s6_context != "@@ -1,2 +1,2 @@\n" "-a\n" "+A\n" " b\n" "\\ No newline at end of file\n")
+        return 6;
+
+    // test hex dumps color bytes by class and switch colors only when the
+    // class changes
+    std::string s7;
+    hexdump().render(s7, "ab\0\n", 4, 0x10);
+
+    if (s7 != "00000010  \033[32m61 62 \033[0;2m00 \033[0;33m0a \033[0m"
+              "                                     "
+              " |\033[32mab\033[0;2m.\033[0;33m.\033[0m|\n")
+        return 7;
+
+    // test offsets from 4 GiB on get more digits instead of wrapping
+    std::string s7_far;
+    hexdump().render(s7_far, "a", 1, 0x123456789abull, false);
+    hexdump().render(s7_far, "a", 1, uint64_t(-16), false);
+
+    if (s7_far.compare(0, 13, "123456789ab  ") != 0 || s7_far.find("\nfffffffffffffff0  61 ") == std::string::npos)
+        return 7;
+
+    // test json is highlighted by token class no matter how it is split
+    // into chunks
+    std::string s8_doc = "{\"k\": [1, \"s\\\"\", true]}";
+    std::stringstream s8_whole, s8_split;
+    s8_whole << colorize;
+    s8_split << colorize;
+    {
+        json_highlighter whole(s8_whole), split(s8_split);
+        whole.feed(s8_doc);
+        for (size_t i = 0; i < s8_doc.size(); ++i)
+            split.feed(s8_doc.data() + i, 1);
+    }
+
+    if (s8_whole.str() != s8_split.str() ||
+        s8_whole.str() != "\033[2m{\033[0;1;34m\"k\"\033[0;2m: [\033[0;36m1\033[0;2m, "
+                          "\033[0;32m\"s\\\"\"\033[0;2m, \033[0;35mtrue\033[0;2m]}\033[0m")
+        return 8;
+
+    // test logfmt levels and keys are colored and lines split between
+    // chunks come out the same
+    std::string s9_log = "level=WARN msg=\"a b\" code=7\nplain\n";
+    std::stringstream s9_whole, s9_split;
+    s9_whole << colorize;
+    s9_split << colorize;
+    {
+        logfmt_colorizer whole(s9_whole), split(s9_split);
+        whole.key("code", style().cyan());
+        split.key("code", style().cyan());
+        whole.feed(s9_log);
+        split.feed(s9_log.substr(0, 13));
+        split.feed(s9_log.substr(13));
+    }
+
+    if (s9_whole.str() != s9_split.str() ||
+        s9_whole.str() != "\033[2mlevel=\033[0;33mWARN \033[0;2mmsg=\033[0;32m\"a b\" "
+                          "\033[0;2mcode=\033[0;36m7\033[0m\nplain\n")
+        return 9;
+
+    // test a line that switches between long escapes at most bytes (two
+    // switches per three bytes with empty keys) fits any buffer size
+    std::string s9_dense;
+    for (int i = 0; i < 2000; ++i)
+        s9_dense += "a=x b=y =z ";
+    s9_dense += "\n";
+    std::stringstream s9_small, s9_large;
+    s9_small << colorize;
+    s9_large << colorize;
+    {
+        logfmt_colorizer small(s9_small, 16), large(s9_large, 1 << 20);
+        small.keys(style().color(1, 2, 3)).values(style().on_color(4, 5, 6));
+        large.keys(style().color(1, 2, 3)).values(style().on_color(4, 5, 6));
+        small.feed(s9_dense);
+        large.feed(s9_dense);
+    }
+
+    if (s9_small.str() != s9_large.str() ||
+        s9_small.str().find("\033[38;2;1;2;3ma=\033[0;48;2;4;5;6mx \033[0;38;2;1;2;3m") != 0)
+        return 9;
+
+#if defined(__linux__)
+    // test a stalled descriptor never blocks the writer: frames are
+    // coalesced, writes that don't fit are dropped, and the latest frame
+    // goes out once the reader catches up
+    int s10_pipe[2];
+    if (::pipe(s10_pipe) != 0)
+        return 10;
+    ::fcntl(s10_pipe[1], F_SETFL, ::fcntl(s10_pipe[1], F_GETFL) | O_NONBLOCK);
+    char s10_chunk[4096] = {};
+    size_t s10_filled = 0;
+    for (ssize_t n; (n = ::write(s10_pipe[1], s10_chunk, sizeof(s10_chunk))) > 0; )
+        s10_filled += static_cast<size_t>(n);
+    {
+        nonblocking_output out(s10_pipe[1], 1024);
+        out.frame("status", "\r\033[32m10%\033[0m");
+        out.frame("status", "\r\033[32m20%\033[0m");
+        out.frame("status", "\r\033[32m30%\033[0m");
+        bool s10_dropped = !out.write(std::string(2000, 'x'));
+
+        nonblocking_output::stats stats = out.statistics();
+        if (!s10_dropped || stats.dropped != 2000 || stats.coalesced != 2 * 13 || stats.pending != 13)
+            return 10;
+
+        for (size_t left = s10_filled; left; )
+            left -= static_cast<size_t>(::read(s10_pipe[0], s10_chunk, std::min(left, sizeof(s10_chunk))));
+        if (!out.flush(std::chrono::seconds(5)))
+            return 10;
+
+        ssize_t n = ::read(s10_pipe[0], s10_chunk, sizeof(s10_chunk));
+        if (std::string(s10_chunk, n > 0 ? static_cast<size_t>(n) : 0) != "\r\033[32m30%\033[0m" ||
+            out.statistics().written != 13)
+            return 10;
+    }
+
+    // test without descriptors for epoll and eventfd, writes go straight
+    // through and the descriptor's flags are left alone
+    std::vector<int> s10_taken;
+    struct rlimit s10_limit, s10_low;
+    ::getrlimit(RLIMIT_NOFILE, &s10_limit);
+    s10_low = s10_limit;
+    s10_low.rlim_cur = 64;
+    ::setrlimit(RLIMIT_NOFILE, &s10_low);
+    for (int fd; (fd = ::dup(s10_pipe[0])) >= 0; )
+        s10_taken.push_back(fd);
+    {
+        int s10_flags = ::fcntl(s10_pipe[1], F_GETFL);
+        ::fcntl(s10_pipe[1], F_SETFL, s10_flags & ~O_NONBLOCK);
+        nonblocking_output out(s10_pipe[1]);
+        bool s10_written = out.write("abc") && out.flush(std::chrono::seconds(0));
+        ssize_t n = ::read(s10_pipe[0], s10_chunk, sizeof(s10_chunk));
+        if (!s10_written || std::string(s10_chunk, n > 0 ? static_cast<size_t>(n) : 0) != "abc" ||
+            (::fcntl(s10_pipe[1], F_GETFL) & O_NONBLOCK) || out.statistics().written != 3)
+            return 10;
+    }
+    for (size_t i = 0; i < s10_taken.size(); ++i)
+        ::close(s10_taken[i]);
+    ::setrlimit(RLIMIT_NOFILE, &s10_limit);
+
+    ::close(s10_pipe[0]);
+    ::close(s10_pipe[1]);
+#endif
+
+    // test images reuse the colors already set: a full block instead of
+    // an escape, and no escape at all for a repeated cell
+    uint8_t const s11_pixels[] =
+    {
+        255, 0, 0,      255, 0, 0,
+        0, 0, 255,      255, 0, 0,
+        0, 255, 0,      0, 255, 0,
+    };
+    std::string s11;
+    image_renderer().threads(1).render(s11, s11_pixels, 2, 3);
+
+    if (s11 != "\033[38;2;255;0;0;48;2;0;0;255m\xe2\x96\x80\xe2\x96\x88\033[0m\n"
+               "\033[38;2;0;255;0m\xe2\x96\x80\xe2\x96\x80\033[0m\n" ||
+        nearest_color_index(255, 0, 0) != 196 || nearest_color_index(128, 128, 128) != 244)
+        return 11;
+
+#if defined(__unix__) || defined(__unix) || defined(__APPLE__)
+    // test report chunks come out in order, each one closed with a reset
+    // unless it already ends in the default state
+    int s12_pipe[2];
+    if (::pipe(s12_pipe) != 0)
+        return 12;
+    report_builder s12_report(s12_pipe[1]);
+    s12_report.workers(3).window(2).colors(true);
+    bool s12_ok = s12_report.run(5, [](std::ostream& out, size_t chunk) {
+        if (chunk % 2)
+            out << blue << chunk << reset;
+        else
+            out << red << chunk;
+    });
+    ::close(s12_pipe[1]);
+
+    std::string s12;
+    char s12_chunk[256];
+    for (ssize_t n; (n = ::read(s12_pipe[0], s12_chunk, sizeof(s12_chunk))) > 0; )
+        s12.append(s12_chunk, static_cast<size_t>(n));
+    ::close(s12_pipe[0]);
+
+    if (!s12_ok || s12 != "\033[31m0\033[0m\033[34m1\033[00m\033[31m2\033[0m"
+                         "\033[34m3\033[00m\033[31m4\033[0m")
+        return 12;
+#endif
+
+#if (__cplusplus >= 201100)
+    // test colors and the default style are usable in constant expressions
+    constexpr __color_rgb_24bit s13_color = on_color(1, 2, 3);
+    constexpr style s13_style;
+    static_assert(!s13_color.foreground && s13_color.blue == 3, "constexpr on_color()");
+    if (!(s13_style == style()))
+        return 13;
+#endif
+
+    // test a recording fed byte by byte replays the same, and as plain
+    // text, as HTML, and from the middle
+    std::string s14_input = "plain \033[1;31merror\033[0m: a<b & \033[32mok\033[K\033[0m\n";
+    std::ostringstream s14_file;
+    {
+        recorder s14_rec(s14_file, 8);
+        for (size_t i = 0; i < s14_input.size(); ++i)
+            s14_rec.feed(&s14_input[i], 1);
+    }
+    std::string s14_data = s14_file.str();
+    replayer s14_rep(s14_data.data(), s14_data.size());
+    std::string s14_ansi, s14_plain, s14_html, s14_middle;
+    s14_rep.render(s14_ansi, replayer::ansi);
+    s14_rep.render(s14_plain, replayer::plain);
+    s14_rep.render(s14_html, replayer::html);
+    s14_rep.render(s14_middle, replayer::ansi, 8, 16);
+
+    if (!s14_rep.valid() || s14_rep.text_size() != 25 || s14_ansi != s14_input ||
+        s14_plain != "plain error: a<b & ok\n" ||
+        s14_html != "plain <span style=\"color:#cd0000;font-weight:bold;\">error</span>: a&lt;b &amp; "
+                    "<span style=\"color:#00cd00;\">ok</span>\n" ||
+        s14_middle != "\033[1;31mror\033[0m: a<b")
+        return 14;
+
+    // test reversed ranges and recordings that aren't valid render nothing
+    std::string s14_reversed, s14_invalid;
+    size_t s14_runs = 0;
+    s14_rep.render(s14_reversed, replayer::plain, 3, 2);
+    s14_rep.for_each_run(16, 8, [&](style const&, char const*, size_t, uint64_t) { ++s14_runs; });
+    replayer s14_garbage("not a recording", 15);
+    s14_garbage.render(s14_invalid, replayer::ansi);
+    s14_garbage.render(s14_invalid, replayer::html, 0, 10);
+
+    if (!s14_reversed.empty() || s14_runs != 0 || s14_garbage.valid() || !s14_invalid.empty())
+        return 14;
+
+    // test bright colors replay as HTML with palette entries 8-15
+    std::ostringstream s14_bright_file;
+    {
+        recorder s14_bright_rec(s14_bright_file);
+        s14_bright_rec.feed("\033[91mwarn\033[0m \033[104mnote\033[0m");
+    }
+    std::string s14_bright_data = s14_bright_file.str(), s14_bright;
+    replayer(s14_bright_data.data(), s14_bright_data.size()).render(s14_bright, replayer::html);
+
+    if (s14_bright != "<span style=\"color:#ff0000;\">warn</span> "
+                      "<span style=\"background:#5c5cff;\">note</span>")
+        return 14;
+
+    // test many styles used again replay the same, named and indexed alike
+    std::ostringstream s14_many_file;
+    std::string s14_many_expected;
+    {
+        recorder s14_many_rec(s14_many_file);
+        for (int pass = 0; pass < 2; ++pass)
+            for (unsigned i = 0; i < 300; ++i)
+            {
+                style s14_s = style().color(static_cast<uint8_t>(i), 0, static_cast<uint8_t>(i >> 8));
+                s14_many_rec.set_style(s14_s).text("x", 1);
+                append(s14_many_expected, i ? style().color(static_cast<uint8_t>(i - 1), 0, static_cast<uint8_t>((i - 1) >> 8))
+                                            : pass ? style().color(43, 0, 1) : style(), s14_s);
+                s14_many_expected += 'x';
+            }
+        s14_many_rec.set_style(style().color(1)).text("a", 1).set_style(style().red()).text("b", 1);
+        append(s14_many_expected, style().color(43, 0, 1), style().red());
+        s14_many_expected += "ab\033[0m";
+    }
+    std::string s14_many_data = s14_many_file.str(), s14_many;
+    replayer s14_many_rep(s14_many_data.data(), s14_many_data.size());
+    s14_many_rep.render(s14_many, replayer::ansi);
+
+    if (s14_many != s14_many_expected)
+        return 14;
+
+    // test table columns are aligned and cut, and styles change only where
+    // needed: spaces keep a foreground color, not a background
+    table s15;
+    s15.max_width(0, 8).align(2, table::right);
+    s15.row().cell("name", style().bold()).cell("status", style().bold()).cell("ms", style().bold());
+    s15.row().cell("alpha").cell("PASS", style().green()).cell("12");
+    s15.row().cell("beta-long-name").cell("FAIL", style().red().bold()).cell("1234");
+    s15.row().cell("\xe6\x97\xa5\xe6\x9c\xac").cell("skip", style().on_blue()).cell("7", style().on_blue());
+    std::string s15_colored, s15_plain;
+    s15.render(s15_colored);
+    s15.render(s15_plain, false);
+
+    if (s15_colored != "\033[1mname      status    ms\033[0m\n"
+                       "alpha     \033[32mPASS      \033[0m12\n"
+                       "beta-lo\xe2\x80\xa6  \033[1;31mFAIL    \033[0m1234\n"
+                       "\xe6\x97\xa5\xe6\x9c\xac      \033[44mskip\033[0m       \033[44m7\033[0m\n" ||
+        s15_plain != "name      status    ms\n"
+                     "alpha     PASS      12\n"
+                     "beta-lo\xe2\x80\xa6  FAIL    1234\n"
+                     "\xe6\x97\xa5\xe6\x9c\xac      skip       7\n")
+        return 15;
+
+    // test styled strings are sliced, joined and restyled on their runs,
+    // and render back to the escapes they were parsed from
+    styled_string s16 = styled_string::parse("plain \033[1;31merror\033[0m: \033[32mok\033[K\033[0m");
+    styled_string s16_joined = styled_string("a", style().red()) + styled_string("b", style().red());
+    styled_string s16_message("error", style().red().bold());
+    s16_message.append(": file not found").restyle(2, 5, style().green());
+
+    if (s16.runs().size() != 4 || s16.width() != 15 ||
+        s16.str() != "plain \033[1;31merror\033[0m: \033[32mok\033[K\033[0m" ||
+        s16.str(false) != "plain error: ok\033[K" ||
+        s16.substr(8, 5).str() != "\033[1;31mror\033[0m: " || s16.substr(8, 5).width() != 5 ||
+        !(styled_string::parse(s16.str()) == s16) ||
+        s16_joined.runs().size() != 1 || s16_joined != styled_string("ab", style().red()) ||
+        s16_message.str() != "\033[1;31mer\033[0;32mror: \033[0mfile not found" ||
+        s16_message.runs().size() != 3 || !(s16_message.style_at(3) == style().green()))
+        return 16;
+
+    // test the 16 basic indexed colors round-trip through their short
+    // codes, and equal the named colors they are read back as
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        style s16_fg = style().color(static_cast<uint8_t>(i));
+        style s16_bg = style().on_color(static_cast<uint8_t>(i));
+        styled_string s16_indexed("x", s16_fg);
+        s16_indexed.append("y", s16_bg);
+        std::string s16_sgr;
+        append(s16_sgr, s16_fg);
+
+        if (!(styled_string::parse(s16_indexed.str()) == s16_indexed) ||
+            !(style().apply(s16_sgr.data() + 2, s16_sgr.size() - 3) == s16_fg))
+            return 16;
+    }
+    std::string s16_same;
+    append(s16_same, style().color(1), style().red());
+    append(s16_same, style().on_color(7), style().on_white());
+    if (!s16_same.empty() || !(style().color(1) == style().red()) || style().color(9) == style().red())
+        return 16;
+
+    // test piecemeal escapes are merged and dropped where no text follows,
+    // erasing gets its background, unknown attributes are kept verbatim,
+    // and splitting the input anywhere changes nothing
+    std::string s17_input = "\033[00m\033[1m\033[31mERROR\033[00m \033[00m\033[1m\033[31mdisk\033[00m\033[0m\033[32m\033[0m ok\n"
+                            "\033[44m\033[K\033[0m\033[3mitalic\033[0m \033[1mb\033[0m";
+    std::string s17_expected = "\033[1;31mERROR\033[0m \033[1;31mdisk\033[0m ok\n"
+                               "\033[44m\033[K\033[0m\033[3mitalic\033[0m \033[1mb\033[0m";
+    sgr_minifier s17_minifier;
+    std::string s17_split;
+    for (size_t i = 0; i < s17_input.size(); ++i)
+        s17_minifier.feed(&s17_input[i], 1, s17_split);
+    s17_minifier.finish(s17_split);
+
+    if (minify(s17_input) != s17_expected || s17_split != s17_expected ||
+        s17_minifier.bytes_in() != s17_input.size() || s17_minifier.bytes_out() != s17_expected.size())
+        return 17;
+
+    // test bright and basic indexed colors keep their short codes, so
+    // 16-color output never grows
+    std::string s17_bright = "\033[1;91mx\033[0m \033[1;91my\033[0m \033[38;5;3;104mz\033[0m";
+    if (minify("\033[91mwarn\033[0m") != "\033[91mwarn\033[0m" ||
+        minify(s17_bright) != "\033[1;91mx\033[0m \033[1;91my\033[0m \033[33;104mz\033[0m")
+        return 17;
+
+#if defined(__unix__) || defined(__unix) || defined(__APPLE__)
+    // test a range of log lines renders with the colors active before it,
+    // plain without escapes, and the same from a reloaded sidecar index
+    std::string s18_path = "termcolor_test_" + std::to_string(::getpid()) + ".log";
+    {
+        std::ofstream s18_file(s18_path.c_str(), std::ios::binary);
+        s18_file << "a\n\033[31mb\n c\033[0m\n\033[1md\n e";
+    }
+    std::string s18_colored, s18_plain, s18_reloaded;
+    bool s18_from_sidecar, s18_other_interval;
+    {
+        indexed_log s18_log(s18_path, 2);
+        s18_log.render(s18_colored, 2, 2);
+        s18_log.render(s18_plain, 0, 10, false);
+        if (s18_log.lines() != 5 || !(s18_log.style_at(4) == style().bold()) || s18_log.indexed_from_sidecar())
+            return 18;
+    }
+    {
+        indexed_log s18_log(s18_path, 2);
+        s18_log.render(s18_reloaded, 2, 2);
+        s18_from_sidecar = s18_log.indexed_from_sidecar() && s18_log.lines() == 5;
+    }
+    {
+        indexed_log s18_log(s18_path, 3);
+        s18_other_interval = !s18_log.indexed_from_sidecar();
+    }
+
+    // A damaged sidecar (huge line and checkpoint counts that agree with
+    // each other, or checkpoints out of order) is rebuilt, not trusted.
+    bool s18_rebuilt = true;
+    for (int damage = 0; damage < 2; ++damage)
+    {
+        {
+            std::fstream s18_sidecar(indexed_log::sidecar_path(s18_path).c_str(),
+                                     std::ios::in | std::ios::out | std::ios::binary);
+            uint64_t s18_lines = uint64_t(3) << 40, s18_count = uint64_t(1) << 40, s18_offset = 0;
+            if (damage == 0)
+            {
+                s18_sidecar.seekp(40);
+                s18_sidecar.write(reinterpret_cast<char const*>(&s18_lines), 8);
+                s18_sidecar.write(reinterpret_cast<char const*>(&s18_count), 8);
+            }
+            else
+            {
+                s18_sidecar.seekp(65);
+                s18_sidecar.write(reinterpret_cast<char const*>(&s18_offset), 8);
+            }
+        }
+        indexed_log s18_log(s18_path, 3);
+        std::string s18_again;
+        s18_log.render(s18_again, 2, 2);
+        s18_rebuilt = s18_rebuilt && !s18_log.indexed_from_sidecar() && s18_log.lines() == 5 && s18_again == s18_colored;
+    }
+    std::remove(s18_path.c_str());
+    std::remove(indexed_log::sidecar_path(s18_path).c_str());
+
+    if (s18_colored != "\033[31m c\033[0m\n\033[1md\n\033[0m" || s18_plain != "a\nb\n c\nd\n e" ||
+        s18_reloaded != s18_colored || !s18_from_sidecar || !s18_other_interval || !s18_rebuilt)
+        return 18;
+#endif
+
+#if defined(__linux__)
+    // test children's lines come out whole, tagged, each one opening the
+    // child's own state and closing it, and failing to start is reported
+    int s19_pipe[2];
+    if (::pipe(s19_pipe) != 0)
+        return 19;
+    output_mux s19_mux(s19_pipe[1]);
+    s19_mux.colors(true);
+    std::vector<std::string> s19_colored, s19_missing;
+    s19_colored.push_back("sh");
+    s19_colored.push_back("-c");
+    s19_colored.push_back("printf '\\033[1mx\\ny\\033[0m\\nz'; exit 3");
+    s19_missing.push_back("/nonexistent/termcolor");
+    s19_mux.spawn(s19_colored, "a| ", style().red(), output_mux::pty);
+    s19_mux.spawn(s19_missing, "b| ");
+    bool s19_ok = s19_mux.run();
+    ::close(s19_pipe[1]);
+
+    std::string s19;
+    char s19_chunk[256];
+    for (ssize_t n; (n = ::read(s19_pipe[0], s19_chunk, sizeof(s19_chunk))) > 0; )
+        s19.append(s19_chunk, static_cast<size_t>(n));
+    ::close(s19_pipe[0]);
+
+    // Lines of different children may come in any order.
+    size_t s19_x = s19.find("\033[31ma| \033[0m\033[1mx\033[0m\n");
+    size_t s19_y = s19.find("\033[31ma| \033[0;1my\033[0m\n");
+    size_t s19_z = s19.find("\033[31ma| \033[0mz\n");
+    if (!s19_ok || s19_mux.lines() != 4 || s19_x == std::string::npos || s19_y == std::string::npos ||
+        s19_z == std::string::npos || !(s19_x < s19_y && s19_y < s19_z) ||
+        s19.find("b| termcolor: cannot run /nonexistent/termcolor\n") == std::string::npos ||
+        WEXITSTATUS(s19_mux.exit_status(0)) != 3 || WEXITSTATUS(s19_mux.exit_status(1)) != 127)
+        return 19;
+#endif
+
     return 0;
 }
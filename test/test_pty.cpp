@@ -0,0 +1,429 @@
+//!
+//! termcolor's pty test
+//! ~~~~~~~~~~~~~~~~~~~~
+//!
+//! Runs termcolor output inside a pseudo-terminal, so the tty code path
+//! (`is_atty()` is true for `std::cout`) is taken exactly as in a real
+//! terminal. The bytes that reach the terminal are checked against the
+//! expected escape sequences, and the throughput and the number of write
+//! syscalls of colored output are measured and printed.
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#   include <util.h>
+#else
+#   include <pty.h>
+#endif
+
+#include "termcolor/termcolor.hpp"
+#include "termcolor/style.hpp"
+#include "termcolor/progress.hpp"
+#include "termcolor/nonblocking.hpp"
+#include "termcolor/probe.hpp"
+
+using namespace termcolor;
+
+namespace
+{
+    //! What a body run in a pty left behind.
+    struct pty_run
+    {
+        std::string output;     // bytes read from the master side
+        long long   writes;     // write syscalls made by the body, -1 if unknown
+        double      seconds;    // time spent in the body, including the flush
+        bool        ok;
+    };
+
+    //! Number of write syscalls made so far by this process, -1 where
+    //! /proc/self/io is not available.
+    long long write_syscalls()
+    {
+        std::ifstream io("/proc/self/io");
+        std::string key;
+        long long value;
+        while (io >> key >> value)
+            if (key == "syscw:")
+                return value;
+        return -1;
+    }
+
+    //! Run \a body in a child process whose stdin, stdout and stderr are
+    //! the slave side of a new pty in raw mode (no "\n" to "\r\n"
+    //! translation), and collect everything it writes.
+    template <typename Body>
+    pty_run run_in_pty(Body body)
+    {
+        pty_run run;
+        run.writes  = -1;
+        run.seconds = 0;
+        run.ok      = false;
+
+        int channel[2];
+        if (::pipe(channel) != 0)
+            return run;
+
+        struct termios raw;
+        std::memset(&raw, 0, sizeof(raw));
+        ::cfmakeraw(&raw);
+        struct winsize size;
+        std::memset(&size, 0, sizeof(size));
+        size.ws_row = 24;
+        size.ws_col = 80;
+
+        // Whatever is buffered would otherwise be written twice.
+        std::cout.flush();
+        std::fflush(stdout);
+
+        int master = -1;
+        pid_t pid = ::forkpty(&master, 0, &raw, &size);
+        if (pid < 0)
+        {
+            ::close(channel[0]);
+            ::close(channel[1]);
+            return run;
+        }
+
+        if (pid == 0)
+        {
+            ::close(channel[0]);
+
+            long long before = write_syscalls();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            body();
+            std::cout.flush();
+            double report[2];
+            report[0] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            long long after = write_syscalls();
+            report[1] = before < 0 || after < 0 ? -1.0 : static_cast<double>(after - before);
+
+            ssize_t written = ::write(channel[1], report, sizeof(report));
+            ::_exit(written == sizeof(report) ? 0 : 1);
+        }
+
+        ::close(channel[1]);
+
+        // Once the child is gone, reading the master fails with EIO.
+        char buffer[1 << 16];
+        for (;;)
+        {
+            ssize_t n = ::read(master, buffer, sizeof(buffer));
+            if (n > 0)
+                run.output.append(buffer, static_cast<size_t>(n));
+            else if (n < 0 && errno == EINTR)
+                continue;
+            else
+                break;
+        }
+
+        double report[2];
+        ssize_t received = ::read(channel[0], report, sizeof(report));
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        ::close(master);
+        ::close(channel[0]);
+
+        run.ok = received == sizeof(report) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (run.ok)
+        {
+            run.seconds = report[0];
+            run.writes  = static_cast<long long>(report[1]);
+        }
+        return run;
+    }
+
+    std::string escaped(std::string const& s)
+    {
+        std::string out;
+        for (size_t i = 0; i < s.size(); ++i)
+        {
+            if (s[i] == '\033')
+                out += "\\033";
+            else if (s[i] == '\n')
+                out += "\\n";
+            else
+                out += s[i];
+        }
+        return out;
+    }
+
+    bool check(pty_run const& run, std::string const& expected)
+    {
+        if (run.ok && run.output == expected)
+            return true;
+        std::cerr << "expected: " << escaped(expected) << "\n"
+                  << "actual:   " << escaped(run.output) << (run.ok ? "" : " (child failed)") << "\n";
+        return false;
+    }
+
+    void basic()
+    {
+        std::cout << red << "r" << on_blue << bold << "b" << reset << "\n";
+    }
+
+    void extended()
+    {
+        std::cout << color(200) << "i" << on_color(10, 20, 30) << "t" << reset;
+    }
+
+    void tty_ignores_nocolorize()
+    {
+        std::cout << nocolorize << green << "g" << reset;
+    }
+
+    void string_stays_plain()
+    {
+        std::ostringstream s;
+        s << red << "plain";
+        std::cout << s.str();
+    }
+
+    void styles()
+    {
+        std::cout << style().red().bold() << "s" << reset;
+    }
+
+    void progress_frames()
+    {
+        progress bars(std::cout);
+        bars.label_width(2).bar_width(4);
+        bars.add("a", 4);
+        bars.add("b", 4);
+        bars.render();
+        bars.set(1, 2);
+        bars.render();
+    }
+
+#if defined(__linux__)
+    void nonblocking_stream()
+    {
+        nonblocking_output out(STDOUT_FILENO);
+        nonblocking_streambuf buffer(out);
+        std::ostream stream(&buffer);
+        stream << colorize << red << "n" << reset << std::flush;
+    }
+#endif
+
+    void limited_colors()
+    {
+        std::cout << max_colors(colors_256) << color(255, 0, 0) << "x"
+                  << max_colors(colors_16) << color(196) << on_color(0, 0, 205) << "y"
+                  << max_colors(colors_unknown) << color(1, 2, 3) << "z" << reset;
+    }
+
+    //! Probe a pty whose master side is a terminal stand-in: it reads the
+    //! queries up to the DA1 request, then sends \a replies (nothing if
+    //! empty, like a terminal that ignores everything). With \a again the
+    //! probe goes through `probe_terminal()`, and it's probed once more
+    //! after the stand-in is gone, with that answer stored there. With
+    //! \a onto the pty is probed through that descriptor number, which is
+    //! left open on it. The queries received are kept in `stand_in_queries`.
+    std::string stand_in_queries;
+
+    terminal_colors probe_stand_in(std::string const& replies, double& seconds, terminal_colors* again = 0, int onto = -1)
+    {
+        terminal_colors colors;
+        std::memset(&colors, 0, sizeof(colors));
+        seconds = 0;
+
+        struct termios raw;
+        std::memset(&raw, 0, sizeof(raw));
+        ::cfmakeraw(&raw);
+        int master = -1, slave = -1;
+        if (::openpty(&master, &slave, 0, &raw, 0) != 0)
+            return colors;
+
+        stand_in_queries.clear();
+        std::thread terminal([&] {
+            std::string& queries = stand_in_queries;
+            char buffer[256];
+            while (queries.find("\033[c") == std::string::npos)
+            {
+                struct pollfd ready = { master, POLLIN, 0 };
+                if (::poll(&ready, 1, 1000) <= 0)
+                    return;
+                ssize_t n = ::read(master, buffer, sizeof(buffer));
+                if (n <= 0)
+                    return;
+                queries.append(buffer, static_cast<size_t>(n));
+            }
+            if (!replies.empty() && ::write(master, replies.data(), replies.size()) < 0)
+                return;
+        });
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int probed = onto >= 0 ? ::dup2(slave, onto) : slave;
+        colors = again ? probe_terminal(probed, probed, std::chrono::milliseconds(200))
+                       : query_terminal(probed, probed, std::chrono::milliseconds(200));
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        terminal.join();
+        if (again)
+            *again = probe_terminal(probed, probed, std::chrono::milliseconds(200));
+        ::close(slave);
+        ::close(master);
+        return colors;
+    }
+
+    size_t const throughput_lines = 200000;
+
+    //! Colored output the way most programs write it: a manipulator per
+    //! change, a line at a time.
+    void manipulators()
+    {
+        for (size_t i = 0; i < throughput_lines; ++i)
+            std::cout << green << "line " << i << reset << " of " << yellow << "output" << reset << '\n';
+    }
+
+    //! The same output built with style transitions and written in large
+    //! blocks.
+    void buffered()
+    {
+        style const green_ = style().green(), yellow_ = style().yellow(), none;
+        std::string block;
+        for (size_t i = 0; i < throughput_lines; ++i)
+        {
+            append(block, none, green_);
+            block += "line ";
+            _internal::append_number(block, i);
+            append(block, green_, none);
+            block += " of ";
+            append(block, none, yellow_);
+            block += "output";
+            append(block, yellow_, none);
+            block += '\n';
+            if (block.size() >= (1 << 16))
+            {
+                std::cout.write(block.data(), static_cast<std::streamsize>(block.size()));
+                block.clear();
+            }
+        }
+        std::cout.write(block.data(), static_cast<std::streamsize>(block.size()));
+    }
+
+    void measure(char const* name, pty_run const& run)
+    {
+        double mib = static_cast<double>(run.output.size()) / (1 << 20);
+        std::cout << "pty " << name << ": " << mib << " MiB in " << run.seconds << " s, "
+                  << (run.seconds > 0 ? mib / run.seconds : 0) << " MiB/s";
+        if (run.writes >= 0)
+            std::cout << ", " << run.writes << " write syscalls ("
+                      << (run.writes ? run.output.size() / static_cast<size_t>(run.writes) : 0)
+                      << " bytes each)";
+        std::cout << std::endl;
+    }
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    // test plain manipulators reach the terminal unchanged
+    if (!check(run_in_pty(basic), "\033[31mr\033[44m\033[1mb\033[00m\n"))
+        return 1;
+
+    // test 8-bit and 24-bit colors
+    if (!check(run_in_pty(extended), "\033[38;5;200mi\033[48;2;10;20;30mt\033[00m"))
+        return 2;
+
+    // test a tty is colored even if nocolorize is set
+    if (!check(run_in_pty(tty_ignores_nocolorize), "\033[32mg\033[00m"))
+        return 3;
+
+    // test only the tty stream is colored, not a string stream of the
+    // same process
+    if (!check(run_in_pty(string_stays_plain), "plain"))
+        return 4;
+
+    // test styles are written through the manipulators, starting from
+    // the default state
+    if (!check(run_in_pty(styles), "\033[00m\033[1m\033[31ms\033[00m"))
+        return 5;
+
+    // test progress bars are redrawn in place: the second frame goes one
+    // line up and rewrites only the bar that changed; empty bars get no
+    // escapes
+    if (!check(run_in_pty(progress_frames),
+               "a  [....]   0%\033[K\n"
+               "b  [....]   0%\033[K\n"
+               "\033[1Ab  [\033[32m##\033[0m..]  50%\033[K\n"))
+        return 6;
+
+#if defined(__linux__)
+    // test output queued through the non-blocking stream buffer
+    if (!check(run_in_pty(nonblocking_stream), "\033[31mn\033[00m"))
+        return 7;
+#endif
+
+    // test 8-bit and 24-bit colors are downgraded to the stream's limit
+    if (!check(run_in_pty(limited_colors),
+               "\033[38;5;196mx\033[91m\033[44my\033[38;2;1;2;3mz\033[00m"))
+        return 10;
+
+    // test probing terminal stand-ins with true color, 256 colors, 16
+    // colors, and one that stays silent until the timeout; the caller's
+    // state is saved and restored around the probe, never reset
+    double seconds;
+    terminal_colors probed = probe_stand_in(
+        "\033P1$r0;48:2::1:2:3m\033\\" "\033]4;255;rgb:eeee/eeee/eeee\033\\"
+        "\033]10;rgb:ffff/ffff/ffff\033\\" "\033]11;rgb:1e1e/1e1e/2e2e\007" "\033[?62;22c", seconds);
+    if (!probed.answered || probed.depth != colors_24bit || !probed.has_foreground || !probed.has_background ||
+        probed.foreground[0] != 255 || probed.background[0] != 30 || probed.background[2] != 46 ||
+        stand_in_queries.compare(0, 2, "\0337") != 0 || stand_in_queries.find("\0338") == std::string::npos ||
+        stand_in_queries.find("\033[0m") != std::string::npos)
+        return 11;
+
+    probed = probe_stand_in("\033]4;255;rgb:eeee/eeee/eeee\007\033[?1;2c", seconds);
+    if (!probed.answered || probed.depth != colors_256 || probed.has_foreground)
+        return 11;
+
+    probed = probe_stand_in("\033[?6c", seconds);
+    if (!probed.answered || probed.depth != colors_16)
+        return 11;
+
+    probed = probe_stand_in("", seconds);
+    if (probed.answered || probed.depth != colors_unknown || seconds < 0.15 || seconds > 2)
+        return 11;
+
+    // test the probe is cached per terminal: asked again while the pty is
+    // open, it has the first answer; another pty on the same descriptor
+    // number is asked anew; a closed descriptor isn't answered
+    terminal_colors again;
+    int reused = ::open("/dev/null", O_RDONLY);
+    probed = probe_stand_in("\033[?1;2c", seconds, &again, reused);
+    if (reused < 0 || probed.depth != colors_16 || again.depth != colors_16)
+        return 11;
+    probed = probe_stand_in("\033]4;255;rgb:eeee/eeee/eeee\007\033[?1;2c", seconds, &again, reused);
+    if (probed.depth != colors_256 || again.depth != colors_256)
+        return 11;
+    ::close(reused);
+    if (probe_terminal(reused).answered)
+        return 11;
+
+    // measure colored output through the pty
+    pty_run run = run_in_pty(manipulators);
+    if (!run.ok || run.output.empty())
+        return 8;
+    measure("manipulators", run);
+
+    run = run_in_pty(buffered);
+    if (!run.ok || run.output.empty())
+        return 9;
+    measure("buffered", run);
+
+    return 0;
+}
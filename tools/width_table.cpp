@@ -0,0 +1,214 @@
+//!
+//! termcolor's width table generator
+//! ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//!
+//! Generates "include/termcolor/width_table.hpp", the two-level table of
+//! code point widths used by "width.hpp", from the ranges of East Asian
+//! wide and zero-width characters below. The table is compiled into the
+//! header so that nothing is built at run time.
+//!
+//! Without arguments the header is printed to stdout; with a path it is
+//! compared with that file, and the exit status tells whether it's up to
+//! date (ctest runs it that way).
+//!
+//!   width_table > include/termcolor/width_table.hpp
+//!
+//! :license: BSD, see LICENSE for details
+//!
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+struct codepoint_range
+{
+    uint32_t first, last;
+};
+
+static codepoint_range const wide[] =
+{
+    {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC},
+    {0x23F0, 0x23F0}, {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615},
+    {0x2648, 0x2653}, {0x267F, 0x267F}, {0x2693, 0x2693}, {0x26A1, 0x26A1},
+    {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5}, {0x26CE, 0x26CE},
+    {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+    {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B},
+    {0x2728, 0x2728}, {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755},
+    {0x2757, 0x2757}, {0x2795, 0x2797}, {0x27B0, 0x27B0}, {0x27BF, 0x27BF},
+    {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x303E},
+    {0x3041, 0x33FF}, {0x3400, 0x4DBF}, {0x4E00, 0x9FFF}, {0xA000, 0xA4CF},
+    {0xA960, 0xA97F}, {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19},
+    {0xFE30, 0xFE6F}, {0xFF00, 0xFF60}, {0xFFE0, 0xFFE6}, {0x16FE0, 0x16FE4},
+    {0x17000, 0x18AFF}, {0x1B000, 0x1B16F}, {0x1F004, 0x1F004}, {0x1F0CF, 0x1F0CF},
+    {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A}, {0x1F200, 0x1F251}, {0x1F300, 0x1F64F},
+    {0x1F680, 0x1F6FF}, {0x1F7E0, 0x1F7EB}, {0x1F90C, 0x1F9FF}, {0x1FA70, 0x1FAFF},
+    {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD},
+};
+
+static codepoint_range const zero[] =
+{
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF},
+    {0x05C1, 0x05C2}, {0x05C4, 0x05C5}, {0x05C7, 0x05C7}, {0x0610, 0x061A},
+    {0x064B, 0x065F}, {0x0670, 0x0670}, {0x06D6, 0x06DC}, {0x06DF, 0x06E4},
+    {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0x0711, 0x0711}, {0x0730, 0x074A},
+    {0x07A6, 0x07B0}, {0x07EB, 0x07F3}, {0x0816, 0x0819}, {0x081B, 0x0823},
+    {0x0825, 0x0827}, {0x0829, 0x082D}, {0x0859, 0x085B}, {0x08D3, 0x08E1},
+    {0x08E3, 0x0902}, {0x093A, 0x093A}, {0x093C, 0x093C}, {0x0941, 0x0948},
+    {0x094D, 0x094D}, {0x0951, 0x0957}, {0x0962, 0x0963}, {0x0981, 0x0981},
+    {0x09BC, 0x09BC}, {0x09C1, 0x09C4}, {0x09CD, 0x09CD}, {0x09E2, 0x09E3},
+    {0x0A01, 0x0A02}, {0x0A3C, 0x0A3C}, {0x0A41, 0x0A42}, {0x0A47, 0x0A48},
+    {0x0A4B, 0x0A4D}, {0x0A70, 0x0A71}, {0x0A81, 0x0A82}, {0x0ABC, 0x0ABC},
+    {0x0AC1, 0x0AC5}, {0x0AC7, 0x0AC8}, {0x0ACD, 0x0ACD}, {0x0B01, 0x0B01},
+    {0x0B3C, 0x0B3C}, {0x0B3F, 0x0B3F}, {0x0B41, 0x0B44}, {0x0B4D, 0x0B4D},
+    {0x0B82, 0x0B82}, {0x0BC0, 0x0BC0}, {0x0BCD, 0x0BCD}, {0x0C3E, 0x0C40},
+    {0x0C46, 0x0C48}, {0x0C4A, 0x0C4D}, {0x0CBC, 0x0CBC}, {0x0CCC, 0x0CCD},
+    {0x0D41, 0x0D44}, {0x0D4D, 0x0D4D}, {0x0DCA, 0x0DCA}, {0x0DD2, 0x0DD4},
+    {0x0DD6, 0x0DD6}, {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E},
+    {0x0EB1, 0x0EB1}, {0x0EB4, 0x0EBC}, {0x0EC8, 0x0ECD}, {0x0F18, 0x0F19},
+    {0x0F35, 0x0F35}, {0x0F37, 0x0F37}, {0x0F39, 0x0F39}, {0x0F71, 0x0F7E},
+    {0x0F80, 0x0F84}, {0x0F86, 0x0F87}, {0x0F8D, 0x0FBC}, {0x0FC6, 0x0FC6},
+    {0x102D, 0x1030}, {0x1032, 0x1037}, {0x1039, 0x103A}, {0x1058, 0x1059},
+    {0x1160, 0x11FF}, {0x135D, 0x135F}, {0x1712, 0x1714}, {0x1732, 0x1734},
+    {0x1752, 0x1753}, {0x1772, 0x1773}, {0x17B4, 0x17B5}, {0x17B7, 0x17BD},
+    {0x17C6, 0x17C6}, {0x17C9, 0x17D3}, {0x17DD, 0x17DD}, {0x180B, 0x180E},
+    {0x18A9, 0x18A9}, {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F},
+    {0x202A, 0x202E}, {0x2060, 0x2064}, {0x20D0, 0x20F0}, {0x2CEF, 0x2CF1},
+    {0x2DE0, 0x2DFF}, {0x302A, 0x302D}, {0x3099, 0x309A}, {0xA66F, 0xA672},
+    {0xA674, 0xA67D}, {0xA69E, 0xA69F}, {0xA6F0, 0xA6F1}, {0xA802, 0xA802},
+    {0xA806, 0xA806}, {0xA80B, 0xA80B}, {0xA825, 0xA826}, {0xFB1E, 0xFB1E},
+    {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0x101FD, 0x101FD},
+    {0x1D167, 0x1D169}, {0x1D17B, 0x1D182}, {0x1D185, 0x1D18B}, {0x1D1AA, 0x1D1AD},
+    {0xE0001, 0xE0001}, {0xE0020, 0xE007F}, {0xE0100, 0xE01EF},
+};
+
+static void print_bytes(std::ostream& out, std::vector<uint8_t> const& bytes)
+{
+    static char const digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        out << (i % 16 == 0 ? "                " : " ");
+        out << "0x" << digits[bytes[i] >> 4] << digits[bytes[i] & 0xf] << ',';
+        if (i % 16 == 15 || i + 1 == bytes.size())
+            out << '\n';
+    }
+}
+
+static std::string generate()
+{
+    // 0 - one column, 1 - zero columns, 2 - two columns.
+    std::vector<uint8_t> classes(0x110000, 0);
+    for (size_t i = 0; i < sizeof(wide) / sizeof(wide[0]); ++i)
+        for (uint32_t cp = wide[i].first; cp <= wide[i].last; ++cp)
+            classes[cp] = 2;
+    for (size_t i = 0; i < sizeof(zero) / sizeof(zero[0]); ++i)
+        for (uint32_t cp = zero[i].first; cp <= zero[i].last; ++cp)
+            classes[cp] = 1;
+
+    // C0 and C1 control characters (tab too) don't advance the cursor by
+    // a fixed amount, so they are counted as zero columns.
+    for (uint32_t cp = 0; cp < 0x20; ++cp)
+        classes[cp] = 1;
+    for (uint32_t cp = 0x7f; cp < 0xa0; ++cp)
+        classes[cp] = 1;
+
+    std::vector<uint8_t> stage1(0x110000 >> 8), stage2;
+    std::map<std::vector<uint8_t>, size_t> blocks;
+    for (uint32_t block = 0; block < (0x110000 >> 8); ++block)
+    {
+        std::vector<uint8_t> packed(64, 0);
+        for (uint32_t i = 0; i < 256; ++i)
+            packed[i >> 2] = static_cast<uint8_t>(packed[i >> 2] | (classes[(block << 8) | i] << ((i & 3) * 2)));
+
+        std::map<std::vector<uint8_t>, size_t>::iterator it = blocks.find(packed);
+        if (it == blocks.end())
+        {
+            it = blocks.insert(std::make_pair(packed, blocks.size())).first;
+            stage2.insert(stage2.end(), packed.begin(), packed.end());
+        }
+        stage1[block] = static_cast<uint8_t>(it->second);
+    }
+    if (blocks.size() > 256)
+    {
+        std::cerr << "width_table: " << blocks.size() << " distinct blocks don't fit a byte" << std::endl;
+        return std::string();
+    }
+
+    std::ostringstream out;
+    out << "//!\n"
+           "//! width_table\n"
+           "//! ~~~~~~~~~~~\n"
+           "//!\n"
+           "//! Generated by tools/width_table.cpp, do not edit. The two-level table\n"
+           "//! of code point widths used by \"width.hpp\": the high bits of a code\n"
+           "//! point select a 256 code point block in stage 1, identical blocks are\n"
+           "//! shared, and each block in stage 2 keeps 2 bits per code point (0 -\n"
+           "//! one column, 1 - zero columns, 2 - two columns).\n"
+           "//!\n"
+           "//! :copyright: (c) 2017 by Alexey Mission\n"
+           "//! :license: BSD, see LICENSE for details\n"
+           "\n"
+           "#ifndef TERMCOLOR_WIDTH_TABLE_HPP_\n"
+           "#define TERMCOLOR_WIDTH_TABLE_HPP_\n"
+           "\n"
+           "#include <stdint.h>\n"
+           "\n"
+           "namespace termcolor\n"
+           "{\n"
+           "    namespace _internal\n"
+           "    {\n"
+           "        //! Block of each 256 code points.\n"
+           "        inline\n"
+           "        uint8_t const* width_stage1()\n"
+           "        {\n"
+           "            static uint8_t const stage1[" << stage1.size() << "] =\n"
+           "            {\n";
+    print_bytes(out, stage1);
+    out << "            };\n"
+           "            return stage1;\n"
+           "        }\n"
+           "\n"
+           "        //! " << blocks.size() << " distinct blocks of 64 bytes.\n"
+           "        inline\n"
+           "        uint8_t const* width_stage2()\n"
+           "        {\n"
+           "            static uint8_t const stage2[" << stage2.size() << "] =\n"
+           "            {\n";
+    print_bytes(out, stage2);
+    out << "            };\n"
+           "            return stage2;\n"
+           "        }\n"
+           "    } // namespace _internal\n"
+           "} // namespace termcolor\n"
+           "\n"
+           "#endif // TERMCOLOR_WIDTH_TABLE_HPP_\n";
+    return out.str();
+}
+
+int main(int argc, char** argv)
+{
+    std::string table = generate();
+    if (table.empty())
+        return 2;
+
+    if (argc < 2)
+    {
+        std::cout << table;
+        return 0;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    std::ostringstream current;
+    current << file.rdbuf();
+    if (current.str() != table)
+    {
+        std::cerr << argv[1] << " is out of date, regenerate it with width_table" << std::endl;
+        return 1;
+    }
+    return 0;
+}